@@ -0,0 +1,415 @@
+/*
+ * Audible Planets - an expressive, quasi-Ptolemaic semi-modular synthesizer
+ *
+ * Copyright 2024, Greg Recco
+ *
+ * Audible Planets is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * All source for Audible Planets is available at
+ * https://github.com/gregrecco67/AudiblePlanets
+ */
+
+// Micro-benchmarks for the DSP kernels, reported in ns per sample as JSON so that
+// runs can be compared from commit to commit. Each benchmark is timed in several
+// batches and the fastest batch is reported, which is the least disturbed by
+// whatever else the machine is doing.
+
+#include <JuceHeader.h>
+#include <chrono>
+#include "PluginProcessor.h"
+#include "QuadOsc.h"
+#include "FastMath.hpp"
+#include "Envelope.h"
+#include "FXProcessors.h"
+
+static void printUsage()
+{
+	std::cout << "Usage: AudiblePlanetsBenchmarks [options]\n"
+		"  --filter=<text>     only run benchmarks whose name contains text\n"
+		"  --min-time=<s>      time spent on each benchmark (0.5)\n"
+		"  --out=<file.json>   write the results there rather than to stdout\n";
+}
+
+namespace
+{
+	constexpr double sampleRate = 48000.0;
+	constexpr int blockSize = 512;
+
+	volatile float sink = 0.f; // keeps results alive
+
+	struct Result
+	{
+		juce::String name;
+		juce::int64 samples;
+		double nsPerSample;
+	};
+
+	class Runner
+	{
+	public:
+		Runner(juce::String filter_, double minTime_) : filter(std::move(filter_)), minTime(minTime_) {}
+
+		bool wouldRun(const juce::String& name) const { return filter.isEmpty() || name.contains(filter); }
+
+		// body() processes samplesPerCall samples each time it's called
+		template <typename Body>
+		void run(const juce::String& name, int samplesPerCall, Body&& body)
+		{
+			if (!wouldRun(name))
+				return;
+
+			constexpr int numBatches = 5;
+			const double batchTime = minTime / numBatches;
+
+			// warm up, and find how many calls make up a batch
+			juce::int64 callsPerBatch = 1;
+			for (;;) {
+				const double start = juce::Time::getMillisecondCounterHiRes();
+				for (juce::int64 i = 0; i < callsPerBatch; i++)
+					body();
+				const double elapsed = (juce::Time::getMillisecondCounterHiRes() - start) / 1000.0;
+				if (elapsed >= batchTime * 0.5 || callsPerBatch > (juce::int64(1) << 40))
+					break;
+				callsPerBatch *= 2;
+			}
+
+			double best = std::numeric_limits<double>::max();
+			for (int batch = 0; batch < numBatches; batch++) {
+				const auto start = std::chrono::steady_clock::now();
+				for (juce::int64 i = 0; i < callsPerBatch; i++)
+					body();
+				const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+				best = std::min(best, elapsed.count());
+			}
+
+			const auto samples = callsPerBatch * samplesPerCall;
+			results.push_back({ name, samples * numBatches, best / double(samples) });
+			std::cerr << name << ": " << juce::String(best / double(samples), 3) << " ns/sample\n";
+		}
+
+		juce::String toJSON() const
+		{
+			juce::Array<juce::var> benchmarks;
+			for (auto& r : results) {
+				auto entry = new juce::DynamicObject();
+				entry->setProperty("name", r.name);
+				entry->setProperty("samples", r.samples);
+				entry->setProperty("ns_per_sample", r.nsPerSample);
+				benchmarks.add(juce::var(entry));
+			}
+
+			auto context = new juce::DynamicObject();
+			context->setProperty("date", juce::Time::getCurrentTime().toISO8601(true));
+			context->setProperty("cpu", juce::SystemStats::getCpuModel());
+			context->setProperty("num_cpus", juce::SystemStats::getNumCpus());
+			context->setProperty("sample_rate", sampleRate);
+			context->setProperty("block_size", blockSize);
+			context->setProperty("control_block_size", AP_CONTROL_BLOCK_SIZE);
+#if JUCE_DEBUG
+			context->setProperty("build", "debug");
+#else
+			context->setProperty("build", "release");
+#endif
+
+			auto root = new juce::DynamicObject();
+			root->setProperty("context", juce::var(context));
+			root->setProperty("benchmarks", benchmarks);
+			return juce::JSON::toString(juce::var(root));
+		}
+
+	private:
+		const juce::String filter;
+		const double minTime;
+		std::vector<Result> results;
+	};
+
+	// a stereo block of white noise at -6 dB
+	juce::AudioBuffer<float> makeNoise(int numSamples)
+	{
+		juce::AudioBuffer<float> buffer(2, numSamples);
+		juce::Random random(1);
+		for (int ch = 0; ch < 2; ch++)
+			for (int i = 0; i < numSamples; i++)
+				buffer.setSample(ch, i, (random.nextFloat() * 2.f - 1.f) * 0.5f);
+		return buffer;
+	}
+
+	// phases spread over a few turns either side of zero, as the oscillators see them
+	std::vector<float> makeArguments(int count, float range)
+	{
+		std::vector<float> values((size_t)count);
+		juce::Random random(2);
+		for (auto& v : values)
+			v = (random.nextFloat() * 2.f - 1.f) * range;
+		return values;
+	}
+}
+
+//==============================================================================
+static void benchmarkOscillators(Runner& runner)
+{
+	constexpr int n = AP_CONTROL_BLOCK_SIZE;
+	for (auto wave : { Wavetype::sine, Wavetype::sawUp }) {
+		for (int tones = 1; tones <= 6; tones++) {
+			QuadOscillator osc;
+			osc.setSampleRate(sampleRate);
+			QuadOscillator::Params params;
+			params.wave = wave;
+			params.tones = (float)tones;
+			params.detune = 0.1f;
+			params.spread = 0.5f;
+			StereoPositionBlock positions;
+
+			const juce::String name = juce::String("QuadOscillator/renderPositions/") + (wave == Wavetype::sine ? "sine" : "saw") + "/tones:" + juce::String(tones);
+			runner.run(name, n, [&] {
+				osc.renderPositions(220.f, params, positions, n);
+				sink = positions.xL[n - 1];
+			});
+		}
+	}
+}
+
+static void benchmarkEnvelope(Runner& runner)
+{
+	constexpr int n = AP_CONTROL_BLOCK_SIZE;
+	const Envelope::Params params(5.0, 200.0, 0.5, 300.0, 1.0, -1.0, false);
+	const int noteLength = int(sampleRate); // a second held, then released
+
+	Envelope perSample, perBlock;
+	for (auto env : { &perSample, &perBlock }) {
+		env->setSampleRate(sampleRate);
+		env->setParameters(params);
+	}
+
+	// both cycle through a whole note, so every state is part of the average
+	int position = 0;
+	auto advance = [&](Envelope& env) {
+		if (position == 0)
+			env.noteOn();
+		if (position == noteLength)
+			env.noteOff();
+		position = (position + n) % (2 * noteLength);
+	};
+
+	runner.run("Envelope/getNextSample", n, [&] {
+		advance(perSample);
+		float sum = 0.f;
+		for (int i = 0; i < n; i++)
+			sum += perSample.getNextSample();
+		sink = sum;
+	});
+
+	position = 0;
+	float out[n];
+	runner.run("Envelope/renderBlock", n, [&] {
+		advance(perBlock);
+		perBlock.renderBlock(out, n);
+		sink = out[n - 1];
+	});
+}
+
+static void benchmarkEffects(Runner& runner)
+{
+	const juce::dsp::ProcessSpec spec{ sampleRate, (juce::uint32)blockSize, 2 };
+	const auto noise = makeNoise(blockSize);
+	juce::AudioBuffer<float> buffer(2, blockSize);
+
+	// runs an effect over a fresh copy of the noise each time
+	auto runEffect = [&](const juce::String& name, auto& effect) {
+		runner.run(name, blockSize, [&] {
+			buffer.makeCopyOf(noise, true);
+			auto block = juce::dsp::AudioBlock<float>(buffer);
+			effect.process(juce::dsp::ProcessContextReplacing<float>(block));
+			sink = buffer.getSample(0, blockSize - 1);
+		});
+	};
+
+	{
+		ChorusProcessor chorus;
+		chorus.prepare(spec);
+		chorus.setRate(0.5f);
+		chorus.setDepth(0.5f);
+		chorus.setCentreDelay(15.f);
+		chorus.setFeedback(0.3f);
+		chorus.setWet(0.5f);
+		chorus.setDry(0.5f);
+		runEffect("ChorusProcessor", chorus);
+	}
+	{
+		StereoDelayProcessor delay;
+		delay.prepare(spec);
+		delay.setTimeL(0.3f);
+		delay.setTimeR(0.45f);
+		delay.setFB(0.5f);
+		delay.setCutoff(8000.f);
+		delay.setWet(0.5f);
+		delay.setDry(1.f);
+		runEffect("StereoDelayProcessor", delay);
+	}
+	{
+		auto reverb = std::make_unique<PlateReverb<float, uint32_t>>();
+		reverb->prepare(spec);
+		reverb->setSize(1.f);
+		reverb->setDecay(0.6f);
+		reverb->setDamping(8000.f);
+		reverb->setLowpass(12000.f);
+		reverb->setPredelay(0.02f);
+		reverb->setWet(0.5f);
+		reverb->setDry(1.f);
+		runEffect("PlateReverb", *reverb);
+	}
+	for (int function = 0; function <= 16; function++) {
+		WaveShaperProcessor shaper;
+		shaper.prepare(spec);
+		shaper.setFunctionToUse(function);
+		shaper.setGain(12.f, 0.f);
+		shaper.setHighShelfFreqAndQ(6500.f, 1.f);
+		shaper.setLPCutoff(20000.f);
+		shaper.setWet(1.f);
+		shaper.setDry(0.f);
+		runEffect("WaveShaperProcessor/function:" + juce::String(function), shaper);
+	}
+	{
+		RingModulator ringmod;
+		ringmod.prepare(spec);
+		RingModulator::RingModParams params;
+		params.mod1freq = 220.f;
+		params.mod2freq = 330.f;
+		params.mix1 = 0.5f;
+		params.mix2 = 0.5f;
+		params.shape1 = 0.3f;
+		params.spread = 0.2f;
+		ringmod.setParams(params);
+		runEffect("RingModulator", ringmod);
+	}
+	{
+		MBFilterProcessor mbfilter;
+		mbfilter.prepare(spec);
+		mbfilter.setParams(100.f, 2.f, 1.f, 1000.f, 0.5f, 1.f, 8000.f, 2.f, 1.f);
+		runEffect("MBFilterProcessor", mbfilter);
+	}
+}
+
+static void benchmarkFastMath(Runner& runner)
+{
+	constexpr int n = 4096;
+	const auto phases = makeArguments(n, 4.f * juce::MathConstants<float>::pi);
+	const auto inRange = makeArguments(n, juce::MathConstants<float>::pi);
+	const auto xs = makeArguments(n, 2.f), ys = makeArguments(n, 2.f);
+	const auto semitones = makeArguments(n, 24.f);
+
+	// one benchmark per function: out = f(argument) over the whole table
+	auto unary = [&](const juce::String& name, const std::vector<float>& args, auto f) {
+		runner.run(name, n, [&] {
+			float sum = 0.f;
+			for (int i = 0; i < n; i++)
+				sum += f(args[(size_t)i]);
+			sink = sum;
+		});
+	};
+	auto binary = [&](const juce::String& name, auto f) {
+		runner.run(name, n, [&] {
+			float sum = 0.f;
+			for (int i = 0; i < n; i++)
+				sum += f(xs[(size_t)i], ys[(size_t)i]);
+			sink = sum;
+		});
+	};
+
+	unary("FastMath/minimaxSin", phases, [](float x) { return FastMath<float>::minimaxSin(x); });
+	unary("FastMath/fastSin", inRange, [](float x) { return FastMath<float>::fastSin(x); });
+	unary("std/sin", phases, [](float x) { return std::sin(x); });
+	unary("FastMath/minimaxSinInRange", inRange, [](float x) { return FastMath<float>::minimaxSinInRange(x); });
+	unary("std/sin/inRange", inRange, [](float x) { return std::sin(x); });
+	unary("FastMath/fastTanh", xs, [](float x) { return FastMath<float>::fastTanh(x); });
+	unary("std/tanh", xs, [](float x) { return std::tanh(x); });
+	unary("semitonePower", semitones, [](float x) { return semitonePower(x); });
+	unary("std/pow/semitone", semitones, [](float x) { return std::pow(1.0594630943592953f, x); });
+
+	binary("FastMath/fastAtan2", [](float x, float y) { return FastMath<float>::fastAtan2(x, y); });
+	binary("FastMath/fastAtan2Branchless", [](float x, float y) { return FastMath<float>::fastAtan2Branchless(x, y); });
+	binary("std/atan2", [](float x, float y) { return std::atan2(x, y); });
+
+	std::vector<float> angles((size_t)n), magnitudes((size_t)n);
+	runner.run("FastMath/angleAndMagnitude", n, [&] {
+		FastMath<float>::angleAndMagnitude(xs.data(), ys.data(), 0.1f, angles.data(), magnitudes.data(), n);
+		sink = angles[n - 1] + magnitudes[n - 1];
+	});
+	runner.run("std/atan2+sqrt", n, [&] {
+		for (int i = 0; i < n; i++) {
+			const float dy = ys[(size_t)i] - 0.1f;
+			angles[(size_t)i] = std::atan2(dy, xs[(size_t)i]);
+			magnitudes[(size_t)i] = std::sqrt(xs[(size_t)i] * xs[(size_t)i] + dy * dy);
+		}
+		sink = angles[n - 1] + magnitudes[n - 1];
+	});
+}
+
+// SynthVoice::renderNextBlock per algorithm, as one held note through processBlock
+// with the effects empty; the rest of processBlock is part of the cost, as it is
+// for a single voice in a host
+static void benchmarkVoice(Runner& runner)
+{
+	for (int algorithm = 0; algorithm < 4; algorithm++) {
+		const juce::String name = "SynthVoice/algorithm:" + juce::String(algorithm);
+		if (!runner.wouldRun(name))
+			continue;
+
+		auto proc = std::make_unique<APAudioProcessor>();
+		proc->timbreParams.algo->setUserValue((float)algorithm);
+		proc->setPlayConfigDetails(0, 2, sampleRate, blockSize);
+		proc->prepareToPlay(sampleRate, blockSize);
+
+		juce::AudioBuffer<float> buffer(2, blockSize);
+		juce::MidiBuffer midi;
+		midi.addEvent(juce::MidiMessage::noteOn(1, 60, 0.8f), 0);
+		buffer.clear();
+		proc->processBlock(buffer, midi);
+		midi.clear();
+
+		runner.run(name, blockSize, [&] {
+			buffer.clear();
+			proc->processBlock(buffer, midi);
+			sink = buffer.getSample(0, blockSize - 1);
+		});
+
+		proc->releaseResources();
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	juce::ArgumentList args(argc, argv);
+	if (args.containsOption("--help|-h")) {
+		printUsage();
+		return 0;
+	}
+
+	juce::ScopedJuceInitialiser_GUI juceInitialiser;
+	juce::ScopedNoDenormals noDenormals;
+
+	Runner runner(args.getValueForOption("--filter"),
+		args.containsOption("--min-time") ? args.getValueForOption("--min-time").getDoubleValue() : 0.5);
+
+	benchmarkOscillators(runner);
+	benchmarkEnvelope(runner);
+	benchmarkEffects(runner);
+	benchmarkFastMath(runner);
+	benchmarkVoice(runner);
+
+	const auto json = runner.toJSON();
+	if (args.containsOption("--out")) {
+		const auto outFile = args.getFileForOption("--out");
+		if (!outFile.replaceWithText(json)) {
+			std::cerr << "Couldn't write " << outFile.getFullPathName() << "\n";
+			return 1;
+		}
+	}
+	else {
+		std::cout << json << "\n";
+	}
+	return 0;
+}
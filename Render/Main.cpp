@@ -0,0 +1,196 @@
+/*
+ * Audible Planets - an expressive, quasi-Ptolemaic semi-modular synthesizer
+ *
+ * Copyright 2024, Greg Recco
+ *
+ * Audible Planets is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * All source for Audible Planets is available at
+ * https://github.com/gregrecco67/AudiblePlanets
+ */
+
+// Headless renderer: plays a MIDI file through the processor, optionally with a
+// preset loaded, and writes the result to a WAV file as fast as it can.
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+
+static void printUsage()
+{
+	std::cout << "Usage: AudiblePlanetsRender --midi=<file.mid> --out=<file.wav> [options]\n"
+		"  --preset=<file>     gin program (.xml) to load first\n"
+		"  --rate=<hz>         sample rate (48000)\n"
+		"  --block=<samples>   host block size (512)\n"
+		"  --threads=<n>       voice render threads besides the main one (0)\n"
+		"  --pin-threads       pin the voice render threads to cores 1..n\n"
+		"  --parallel-fx       run FX lane B on a voice render thread\n"
+		"  --bpm=<bpm>         tempo when the MIDI file has none (120)\n"
+		"  --tail=<seconds>    time to render after the last event (the effects' tail, up to 10 s)\n"
+		"  --audit             fail if the real-time audit reports anything\n"
+		"                      (debug builds, or built with AP_REALTIME_AUDIT)\n";
+}
+
+// a transport that's always playing, at the tempo of the MIDI file
+class RenderPlayHead : public juce::AudioPlayHead
+{
+public:
+	juce::Optional<PositionInfo> getPosition() const override
+	{
+		PositionInfo info;
+		info.setBpm(bpm);
+		info.setTimeSignature(juce::AudioPlayHead::TimeSignature{});
+		info.setTimeInSamples(timeInSamples);
+		info.setTimeInSeconds(double(timeInSamples) / sampleRate);
+		info.setPpqPosition(double(timeInSamples) / sampleRate * bpm / 60.0);
+		info.setIsPlaying(true);
+		return info;
+	}
+
+	double bpm{ 120.0 }, sampleRate{ 48000.0 };
+	juce::int64 timeInSamples{ 0 };
+};
+
+static bool readMidiFile(const juce::File& file, juce::MidiMessageSequence& sequence, double& bpm)
+{
+	juce::FileInputStream stream(file);
+	juce::MidiFile midiFile;
+	if (!stream.openedOk() || !midiFile.readFrom(stream))
+		return false;
+
+	midiFile.convertTimestampTicksToSeconds();
+	for (int i = 0; i < midiFile.getNumTracks(); i++)
+		sequence.addSequence(*midiFile.getTrack(i), 0.0);
+	sequence.updateMatchedPairs();
+
+	for (auto* event : sequence) {
+		if (event->message.isTempoMetaEvent()) {
+			bpm = 60.0 / event->message.getTempoSecondsPerQuarterNote();
+			break;
+		}
+	}
+	return true;
+}
+
+int main(int argc, char* argv[])
+{
+	juce::ArgumentList args(argc, argv);
+	if (args.containsOption("--help|-h") || !args.containsOption("--midi") || !args.containsOption("--out")) {
+		printUsage();
+		return 1;
+	}
+
+	juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+	auto optionOr = [&](const juce::String& option, double fallback) {
+		return args.containsOption(option) ? args.getValueForOption(option).getDoubleValue() : fallback;
+	};
+	const double sampleRate = optionOr("--rate", 48000.0);
+	const int blockSize = juce::jmax(1, int(optionOr("--block", 512)));
+	const int numThreads = int(optionOr("--threads", 0));
+
+	RenderPlayHead playHead;
+	playHead.sampleRate = sampleRate;
+	playHead.bpm = optionOr("--bpm", 120.0);
+
+	juce::MidiMessageSequence sequence;
+	const auto midiFile = args.getFileForOption("--midi");
+	if (!readMidiFile(midiFile, sequence, playHead.bpm)) {
+		std::cerr << "Couldn't read MIDI file " << midiFile.getFullPathName() << "\n";
+		return 1;
+	}
+
+	auto proc = std::make_unique<APAudioProcessor>();
+
+	if (args.containsOption("--preset")) {
+		const auto presetFile = args.getFileForOption("--preset");
+		if (!presetFile.existsAsFile()) {
+			std::cerr << "Couldn't find preset " << presetFile.getFullPathName() << "\n";
+			return 1;
+		}
+		gin::Program program;
+		program.loadFromFile(presetFile, true);
+		program.loadProcessor(*proc);
+	}
+
+	proc->setVoiceRenderThreads(numThreads, args.containsOption("--pin-threads"));
+	proc->setParallelFXLanes(args.containsOption("--parallel-fx"));
+	proc->setPlayHead(&playHead);
+	proc->setNonRealtime(true);
+	proc->setPlayConfigDetails(0, 2, sampleRate, blockSize);
+	proc->prepareToPlay(sampleRate, blockSize);
+
+	juce::AudioBuffer<float> block(2, blockSize);
+	juce::MidiBuffer midi;
+	midi.ensureSize(4096);
+
+	// the effects only pick up their parameters in processBlock, so run one silent
+	// block before asking for the tail, then clear whatever state it left behind
+	block.clear();
+	proc->processBlock(block, midi);
+	proc->reset();
+
+	const double tail = optionOr("--tail", juce::jmin(proc->getTailLengthSeconds(), 10.0));
+	const auto numSamples = juce::int64(std::ceil((sequence.getEndTime() + tail) * sampleRate));
+
+	// the output is delayed by the reported latency (oversampling), so render that
+	// much more and drop it from the start, as a host would
+	const int latency = proc->getLatencySamples();
+	const auto numRendered = numSamples + latency;
+
+	// each block goes straight to the file, so long renders don't have to fit in memory
+	const auto outFile = args.getFileForOption("--out");
+	outFile.deleteFile();
+	auto stream = std::make_unique<juce::FileOutputStream>(outFile);
+	std::unique_ptr<juce::AudioFormatWriter> writer(juce::WavAudioFormat().createWriterFor(stream.get(), sampleRate, 2, 24, {}, 0));
+	if (writer == nullptr) {
+		std::cerr << "Couldn't write " << outFile.getFullPathName() << "\n";
+		return 1;
+	}
+	stream.release(); // the writer owns it now
+
+	int nextEvent = 0;
+	double seconds = 0.0; // time spent in processBlock, not writing the file
+
+	for (juce::int64 pos = 0; pos < numRendered; pos += blockSize) {
+		const int n = int(juce::jmin(juce::int64(blockSize), numRendered - pos));
+		block.setSize(2, n, false, false, true);
+		block.clear();
+
+		midi.clear();
+		for (; nextEvent < sequence.getNumEvents(); nextEvent++) {
+			const auto& message = sequence.getEventPointer(nextEvent)->message;
+			const auto samplePos = juce::int64(message.getTimeStamp() * sampleRate);
+			if (samplePos >= pos + n)
+				break;
+			if (!message.isMetaEvent())
+				midi.addEvent(message, int(juce::jmax(juce::int64(0), samplePos - pos)));
+		}
+
+		playHead.timeInSamples = pos;
+		const double start = juce::Time::getMillisecondCounterHiRes();
+		proc->processBlock(block, midi);
+		seconds += (juce::Time::getMillisecondCounterHiRes() - start) / 1000.0;
+
+		const int skip = int(juce::jlimit(juce::int64(0), juce::int64(n), latency - pos));
+		if (skip < n && !writer->writeFromAudioSampleBuffer(block, skip, n - skip)) {
+			std::cerr << "Couldn't write " << outFile.getFullPathName() << "\n";
+			return 1;
+		}
+	}
+
+	proc->releaseResources();
+	writer.reset();
+
+	const double audioSeconds = double(numSamples) / sampleRate;
+	std::cout << "Rendered " << audioSeconds << " s in " << seconds << " s ("
+		<< audioSeconds / juce::jmax(seconds, 1e-9) << "x real time) to " << outFile.getFullPathName() << "\n";
+
+	if (args.containsOption("--audit") && RealtimeAudit::getNumViolations() > 0) {
+		std::cerr << "The real-time audit reported " << RealtimeAudit::getNumViolations() << " problem(s)\n";
+		return 2;
+	}
+	return 0;
+}
@@ -8,16 +8,24 @@ APSampler::APSampler(APAudioProcessor& proc_) : proc(proc_)
     enableLegacyMode(12);
     setVoiceStealingEnabled(true);
 
-    for (int i = 0; i < 16; i++)
+    for (int i = 0; i < AP_MAX_VOICES; i++)
     {
         auto voice = new APSamplerVoice(proc);
         proc.modMatrix.addVoice(voice);
         addVoice(voice);
+        voiceRenderer.addVoice(voice);
     }
     
     formatManager.registerBasicFormats();
 }
 
+// voices render on the processor's worker pool when it has threads, otherwise serially
+void APSampler::renderNextSubBlock(juce::AudioBuffer<float>& outputAudio, int startSample, int numSamples)
+{
+    const juce::ScopedLock sl(voicesLock);
+    voiceRenderer.render(proc.voicePool, outputAudio, startSample, numSamples);
+}
+
 bool APSampler::loadSound(const juce::String& path) {
     reader = formatManager.createReaderFor(juce::File(path));
 	if (reader == nullptr) { return false; }
@@ -62,4 +70,5 @@ void APSampler::updateBaseNote(int note)
 
 void APSampler::handleMidiEvent(const juce::MidiMessage& m) {
     MPESynthesiser::handleMidiEvent(m);
+    voiceRenderer.voicesMayHaveStarted();
 }
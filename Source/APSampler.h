@@ -1,6 +1,8 @@
 #pragma once
 #include <JuceHeader.h>
 #include "APSamplerVoice.h"
+#include "WorkerPool.h"
+#include "Polyphony.h"
 
 class APAudioProcessor;
 
@@ -19,4 +21,10 @@ public:
     APAudioProcessor& proc;
     juce::AudioFormatManager formatManager;
     juce::AudioFormatReader* reader{ nullptr };
+
+protected:
+    void renderNextSubBlock(juce::AudioBuffer<float>& outputAudio, int startSample, int numSamples) override;
+
+private:
+    ActiveVoiceRenderer voiceRenderer;
 };
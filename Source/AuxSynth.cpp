@@ -6,14 +6,22 @@ AuxSynth::AuxSynth(APAudioProcessor& proc_) : proc(proc_)
 	enableLegacyMode(12);
 	setVoiceStealingEnabled(true);
 
-	for (int i = 0; i < 16; i++)
+	for (int i = 0; i < AP_MAX_VOICES; i++)
 	{
 		auto voice = new AuxSynthVoice(proc);
 		proc.modMatrix.addVoice(voice);
 		addVoice(voice);
+		voiceRenderer.addVoice(voice);
 	}
 }
 
+// voices render on the processor's worker pool when it has threads, otherwise serially
+void AuxSynth::renderNextSubBlock(juce::AudioBuffer<float>& outputAudio, int startSample, int numSamples)
+{
+	const juce::ScopedLock sl(voicesLock);
+	voiceRenderer.render(proc.voicePool, outputAudio, startSample, numSamples);
+}
+
 juce::Array<float> AuxSynth::getLiveFilterCutoff() {
 	juce::Array<float> values;
 
@@ -88,6 +96,7 @@ std::vector<float> AuxSynth::getMSEG4Phases() {
 
 void AuxSynth::handleMidiEvent(const juce::MidiMessage& m) {
 	MPESynthesiser::handleMidiEvent(m);
+	voiceRenderer.voicesMayHaveStarted();
 
 	if (m.isAftertouch()) {
 		for (auto& voice : voices) {
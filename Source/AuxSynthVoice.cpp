@@ -78,6 +78,7 @@ void AuxSynthVoice::noteStarted()
 	env2.noteOn();
 	env3.noteOn();
 	env4.noteOn();
+	silence.noteStarted();
 
 	mseg1.noteOn();
 	mseg2.noteOn();
@@ -112,6 +113,7 @@ void AuxSynthVoice::noteRetriggered()
 	env2.noteOn();
 	env3.noteOn();
 	env4.noteOn();
+	silence.noteStarted();
 }
 
 void AuxSynthVoice::noteStopped(bool allowTailOff)
@@ -120,6 +122,7 @@ void AuxSynthVoice::noteStopped(bool allowTailOff)
 	env2.noteOff();
 	env3.noteOff();
 	env4.noteOff();
+	silence.noteReleased();
 
 	if (!allowTailOff) {
 		clearCurrentNote();
@@ -175,7 +178,9 @@ void AuxSynthVoice::setCurrentSampleRate(double newRate)
 void AuxSynthVoice::renderNextBlock(juce::AudioBuffer<float>& outputBuffer, int startSample, int numSamples)
 {
 	updateParams(numSamples);
-	gin::ScratchBuffer scratchBuffer(2, numSamples);
+	jassert(numSamples <= AP_MAX_CONTROL_BLOCK_SIZE);
+	scratchBuffer.setSize(2, numSamples, false, false, true);
+	scratchBuffer.clear();
 
 	// oscillator
 
@@ -209,6 +214,8 @@ void AuxSynthVoice::renderNextBlock(juce::AudioBuffer<float>& outputBuffer, int
 	
 	filter.process(scratchBuffer);
 
+	const bool silent = silence.process(scratchBuffer, numSamples, proc.getVoiceSilenceThreshold(), proc.getVoiceSilenceMs(), getSampleRate());
+
 	// Copy synth voice to output
 	outputBuffer.addFrom(0, startSample, scratchBuffer, 0, 0, numSamples);
 	outputBuffer.addFrom(1, startSample, scratchBuffer, 1, 0, numSamples);
@@ -231,7 +238,7 @@ void AuxSynthVoice::renderNextBlock(juce::AudioBuffer<float>& outputBuffer, int
 	}
 
 
-	if (shouldStop)
+	if (shouldStop || silent)
 	{
 		clearCurrentNote();
 		stopVoice();
@@ -483,13 +490,10 @@ void AuxSynthVoice::updateParams(int blockSize)
 	proc.modMatrix.setPolyValue(*this, proc.modSrcEnv3, env3.getOutput());
 	proc.modMatrix.setPolyValue(*this, proc.modSrcEnv4, env4.getOutput());
 
-	for (int i = 0; i < blockSize; ++i)
-	{
-		env1.getNextSample();
-		env2.getNextSample();
-		env3.getNextSample();
-		env4.getNextSample();
-	}
+	env1.renderBlock(nullptr, blockSize);
+	env2.renderBlock(nullptr, blockSize);
+	env3.renderBlock(nullptr, blockSize);
+	env4.renderBlock(nullptr, blockSize);
 
 	noteSmoother.process(blockSize);
 
@@ -15,7 +15,9 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "ControlBlock.h"
 #include "Envelope.h"
+#include "SilenceDetector.h"
 #include "libMTSClient.h"
 #include <numbers>
 class APAudioProcessor;
@@ -66,8 +68,10 @@ private:
 	gin::BLLTVoicedStereoOscillator osc;
 
 	gin::Filter filter;
+	juce::AudioBuffer<float> scratchBuffer{ 2, AP_MAX_CONTROL_BLOCK_SIZE };
 
 	Envelope env1, env2, env3, env4;
+	SilenceDetector silence;
 	int currentEnv;
 	float currentFreq{ 440.f };
 		
@@ -0,0 +1,30 @@
+/*
+ * Audible Planets - an expressive, quasi-Ptolemaic semi-modular synthesizer
+ *
+ * Copyright 2024, Greg Recco
+ *
+ * Audible Planets is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * All source for Audible Planets is available at
+ * https://github.com/gregrecco67/AudiblePlanets
+ */
+
+#pragma once
+
+// processBlock renders in sub-blocks of the control block size, updating parameters
+// and modulation once per sub-block: smaller is snappier, larger is cheaper.
+// The default can be set at compile time and changed at runtime with
+// APAudioProcessor::setControlBlockSize, up to the maximum, which sizes the voices' buffers.
+#ifndef AP_MAX_CONTROL_BLOCK_SIZE
+ #define AP_MAX_CONTROL_BLOCK_SIZE 128
+#endif
+
+#ifndef AP_CONTROL_BLOCK_SIZE
+ #define AP_CONTROL_BLOCK_SIZE 32
+#endif
+
+static_assert(AP_CONTROL_BLOCK_SIZE >= 1 && AP_CONTROL_BLOCK_SIZE <= AP_MAX_CONTROL_BLOCK_SIZE,
+	"control block size must be between 1 and AP_MAX_CONTROL_BLOCK_SIZE");
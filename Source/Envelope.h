@@ -14,40 +14,30 @@
 
 #pragma once
 
-#pragma once
-
 #include <juce_core/juce_core.h>
 #include <juce_audio_basics/juce_audio_basics.h>
 
-class Envelope
+// the envelope's state runs in double by default; defining AP_FLOAT_ENVELOPE as 1
+// runs it in float instead, which is cheaper but drifts on long, slow segments
+#ifndef AP_FLOAT_ENVELOPE
+ #define AP_FLOAT_ENVELOPE 0
+#endif
+
+// Real is the precision of the envelope's state; the synth uses Envelope, below,
+// and both engines are instantiated side by side in Tests/EnvelopePrecisionTest
+template <typename RealType>
+class BasicEnvelope
 {
 public:
+    using Real = RealType;
+
     //==============================================================================
-    Envelope()
+    BasicEnvelope()
     {
-
-        // generate lookup tables for MMA curves, and linear mapping for convenience
-        for (int i = 1; i < 1999; i++)
-        {
-            // MMA curve transforms
-            if ( ((double)i / 2000.0) > 0.996 ) // tail ends blow up, so we go linear for last stretch
-                concave[i] = (double)i / 2000.0;
-            else
-                concave[i] = std::min(-(5.0 / 12.0) * std::log10(1.0 - (double)i / 2000.0), 1.0);
-
-            if ( ((double)i / 2000.0) < 0.004 ) // negative blow-up
-                convex[i] = (double)i / 2000.0;
-            else
-                convex[i] = std::max(1 + (5.0 / 12.0) * std::log10((double)i / 2000.0), 0.0);
-        }
-        concave[0] = 0.0;
-        convex[0] = 0.0;
-        concave[1999] = 1.0;
-        convex[1999] = 1.0;
         recalculateRates();
     }
-    Envelope(const Envelope&) = default;
-    ~Envelope() = default;
+    BasicEnvelope(const BasicEnvelope&) = default;
+    ~BasicEnvelope() = default;
 
 	//==============================================================================
     enum class State { idle, attack, decay, sustain, release, ADRattack, ADRdecay, ADRrelease, ADRSyncIdle };
@@ -153,15 +143,15 @@ public:
             case State::attack:
             {
                 linearIdxVal += attackRate;
-                linearIdxVal = std::clamp(linearIdxVal, 0.0, 1.0);
+                linearIdxVal = std::clamp(linearIdxVal, Real(0), Real(1));
 
                 if (parameters.aCurve > 0.0f) {
-                    curveVal = convex[(int)(linearIdxVal * 2000.)];
-                    finalOut = std::clamp((1.0 - parameters.aCurve) * linearIdxVal + parameters.aCurve * curveVal, 0.0, 1.0);
+                    curveVal = curves->convexAt(linearIdxVal);
+                    finalOut = std::clamp((Real(1) - aCurve) * linearIdxVal + aCurve * curveVal, Real(0), Real(1));
                 }
                 else {
-                    curveVal = concave[(int)(linearIdxVal * 2000.)];
-                    finalOut = std::clamp((1.0 + parameters.aCurve) * linearIdxVal - parameters.aCurve * curveVal, 0.0, 1.0);
+                    curveVal = curves->concaveAt(linearIdxVal);
+                    finalOut = std::clamp((Real(1) + aCurve) * linearIdxVal - aCurve * curveVal, Real(0), Real(1));
                 }
 
                 releaseStart = finalOut; // in case note is released before attack finishes
@@ -179,15 +169,15 @@ public:
             case State::ADRattack:
             {
                 linearIdxVal += attackRate;
-                linearIdxVal = std::clamp(linearIdxVal, 0.0, 1.0);
+                linearIdxVal = std::clamp(linearIdxVal, Real(0), Real(1));
 
                 if (parameters.aCurve > 0.0f) {
-                    curveVal = convex[(int)(linearIdxVal * 2000.)];
-                    finalOut = std::clamp((1.0 - parameters.aCurve) * linearIdxVal + parameters.aCurve * curveVal, 0.0, 1.0);
+                    curveVal = curves->convexAt(linearIdxVal);
+                    finalOut = std::clamp((Real(1) - aCurve) * linearIdxVal + aCurve * curveVal, Real(0), Real(1));
                 }
                 else {
-                    curveVal = concave[(int)(linearIdxVal * 2000.)];
-                    finalOut = std::clamp((1.0 + parameters.aCurve) * linearIdxVal - parameters.aCurve * curveVal, 0.0, 1.0);
+                    curveVal = curves->concaveAt(linearIdxVal);
+                    finalOut = std::clamp((Real(1) + aCurve) * linearIdxVal - aCurve * curveVal, Real(0), Real(1));
                 }
 
                 releaseStart = finalOut; // in case note is released before attack finishes
@@ -212,21 +202,21 @@ public:
             case State::decay:
             {
                 linearIdxVal -= decayRate;
-                linearIdxVal = std::clamp(linearIdxVal, 0.0, 1.0);
+                linearIdxVal = std::clamp(linearIdxVal, Real(0), Real(1));
 
                 if (parameters.dRCurve > 0.0) {
-                    curveVal = convex[(int)(linearIdxVal * 2000.)];
-                    unmappedVal = std::clamp(((1.0 - parameters.dRCurve) * linearIdxVal + parameters.dRCurve * curveVal), 0.0, 1.0);
+                    curveVal = curves->convexAt(linearIdxVal);
+                    unmappedVal = std::clamp(((Real(1) - dRCurve) * linearIdxVal + dRCurve * curveVal), Real(0), Real(1));
                 }
                 else {
-                    curveVal = concave[(int)(linearIdxVal * 2000.)];
-                    unmappedVal = std::clamp(((1.0 + parameters.dRCurve) * linearIdxVal - parameters.dRCurve * curveVal), 0.0, 1.0);
+                    curveVal = curves->concaveAt(linearIdxVal);
+                    unmappedVal = std::clamp(((Real(1) + dRCurve) * linearIdxVal - dRCurve * curveVal), Real(0), Real(1));
                 }
                 
-                finalOut = juce::jmap(unmappedVal, 0.0, 1.0, parameters.sustainLevel, 1.0);
+                finalOut = juce::jmap(unmappedVal, Real(0), Real(1), sustainLevel, Real(1));
                 releaseStart = finalOut;
 
-                if (finalOut <= parameters.sustainLevel)
+                if (finalOut <= sustainLevel)
                 {
                     goToNextState();
                 }
@@ -238,18 +228,18 @@ public:
             case State::ADRdecay:
             {
                 linearIdxVal -= decayRate;
-                linearIdxVal = std::clamp(linearIdxVal, 0.0, 1.0);
+                linearIdxVal = std::clamp(linearIdxVal, Real(0), Real(1));
 
                 if (parameters.dRCurve > 0.0) {
-                    curveVal = convex[(int)(linearIdxVal * 2000.)];
-                    unmappedVal = std::clamp(((1.0 - parameters.dRCurve) * linearIdxVal + parameters.dRCurve * curveVal), 0.0, 1.0);
+                    curveVal = curves->convexAt(linearIdxVal);
+                    unmappedVal = std::clamp(((Real(1) - dRCurve) * linearIdxVal + dRCurve * curveVal), Real(0), Real(1));
                 }
                 else {
-                    curveVal = concave[(int)(linearIdxVal * 2000.)];
-                    unmappedVal = std::clamp(((1.0 + parameters.dRCurve) * linearIdxVal - parameters.dRCurve * curveVal), 0.0, 1.0);
+                    curveVal = curves->concaveAt(linearIdxVal);
+                    unmappedVal = std::clamp(((Real(1) + dRCurve) * linearIdxVal - dRCurve * curveVal), Real(0), Real(1));
                 }
 
-                finalOut = juce::jmap(unmappedVal, 0.0, 1.0, parameters.sustainLevel, 1.0);
+                finalOut = juce::jmap(unmappedVal, Real(0), Real(1), sustainLevel, Real(1));
                 releaseStart = finalOut;
 
                 if (timeSinceStart >= duration)
@@ -257,7 +247,7 @@ public:
                     noteOn();
 				}
 
-                if (finalOut <= parameters.sustainLevel)
+                if (finalOut <= sustainLevel)
                 {
                     goToNextState();
                 }
@@ -269,7 +259,7 @@ public:
             case State::sustain:
             {
                 linearIdxVal = 1.0;
-                finalOut = parameters.sustainLevel;
+                finalOut = sustainLevel;
                 releaseStart = finalOut;
                 break;
             }
@@ -277,18 +267,18 @@ public:
             case State::release:
             {
                 linearIdxVal -= releaseRate;
-                linearIdxVal = std::clamp(linearIdxVal, 0.0, 1.0);
+                linearIdxVal = std::clamp(linearIdxVal, Real(0), Real(1));
 
                 if (parameters.dRCurve > 0.0) {
-                    curveVal = convex[(int)(linearIdxVal * 2000.)];
-                    unmappedVal = std::clamp((1.0 - parameters.dRCurve) * linearIdxVal + parameters.dRCurve * curveVal, 0.0, 1.0);
+                    curveVal = curves->convexAt(linearIdxVal);
+                    unmappedVal = std::clamp((Real(1) - dRCurve) * linearIdxVal + dRCurve * curveVal, Real(0), Real(1));
                 }
                 else if (parameters.dRCurve <= 0.0) {
-                    curveVal = concave[(int)(linearIdxVal * 2000.)];
-                    unmappedVal = std::clamp((1.0 + parameters.dRCurve) * linearIdxVal - parameters.dRCurve * curveVal, 0.0, 1.0);
+                    curveVal = curves->concaveAt(linearIdxVal);
+                    unmappedVal = std::clamp((Real(1) + dRCurve) * linearIdxVal - dRCurve * curveVal, Real(0), Real(1));
                 }
 
-                finalOut = juce::jmap(unmappedVal, 0.0, 1.0, 0.0, releaseStart);
+                finalOut = juce::jmap(unmappedVal, Real(0), Real(1), Real(0), releaseStart);
                 if (linearIdxVal <= 0.0f)
                     goToNextState();
 
@@ -298,18 +288,18 @@ public:
             case State::ADRrelease:
             {
                 linearIdxVal -= releaseRate;
-                linearIdxVal = std::clamp(linearIdxVal, 0.0, 1.0);
+                linearIdxVal = std::clamp(linearIdxVal, Real(0), Real(1));
 
                 if (parameters.dRCurve > 0.0) {
-                    curveVal = convex[(int)(linearIdxVal * 2000.)];
-                    unmappedVal = std::clamp((1.0 - parameters.dRCurve) * linearIdxVal + parameters.dRCurve * curveVal, 0.0, 1.0);
+                    curveVal = curves->convexAt(linearIdxVal);
+                    unmappedVal = std::clamp((Real(1) - dRCurve) * linearIdxVal + dRCurve * curveVal, Real(0), Real(1));
                 }
                 else if (parameters.dRCurve <= 0.0) {
-                    curveVal = concave[(int)(linearIdxVal * 2000.)];
-                    unmappedVal = std::clamp((1.0 + parameters.dRCurve) * linearIdxVal - parameters.dRCurve * curveVal, 0.0, 1.0);
+                    curveVal = curves->concaveAt(linearIdxVal);
+                    unmappedVal = std::clamp((Real(1) + dRCurve) * linearIdxVal - dRCurve * curveVal, Real(0), Real(1));
                 }
 
-                finalOut = juce::jmap(unmappedVal, 0.0, 1.0, 0.0, releaseStart);
+                finalOut = juce::jmap(unmappedVal, Real(0), Real(1), Real(0), releaseStart);
 
                 if (timeSinceStart >= duration)
 					noteOn();
@@ -334,6 +324,58 @@ public:
         return out; // envelopeVal;
     }
 
+    // advance numSamples, writing what getOutput() would return after each one
+    // (out may be null to just advance). Renders a run at a time for as long as
+    // the state holds: idle and sustain are fills, linear attack, decay and
+    // release segments are ramps, and anything else steps sample by sample.
+    void renderBlock(float* out, int numSamples) noexcept
+    {
+        int i = 0;
+        while (i < numSamples)
+        {
+            const int remaining = numSamples - i;
+            int run = 0;
+
+            switch (state)
+            {
+                case State::idle:
+                    run = fill(out, i, remaining, 0.0);
+                    break;
+                case State::sustain:
+                    linearIdxVal = 1.0;
+                    releaseStart = sustainLevel;
+                    run = fill(out, i, remaining, sustainLevel);
+                    break;
+                case State::attack:
+                    if (parameters.aCurve == 0.0)
+                        run = attackRamp(out, i, remaining);
+                    break;
+                case State::decay:
+                    if (parameters.dRCurve == 0.0 && parameters.sustainLevel < 1.0)
+                        run = decayRamp(out, i, remaining);
+                    break;
+                case State::release:
+                    if (parameters.dRCurve == 0.0)
+                        run = releaseRamp(out, i, remaining);
+                    break;
+                default:
+                    break;
+            }
+
+            if (run == 0) // curved or looping segment
+            {
+                const State current = state;
+                for (; i < numSamples && state == current; i++)
+                {
+                    getNextSample();
+                    if (out != nullptr)
+                        out[i] = (float)finalOut;
+                }
+            }
+            i += run;
+        }
+    }
+
     void processMultiplying(juce::AudioSampleBuffer& buffer) {
         auto numSamples = buffer.getNumSamples();
         auto outLeft = buffer.getWritePointer(0);
@@ -351,15 +393,15 @@ public:
                 case State::attack:
                 {
                     linearIdxVal += attackRate;
-                    linearIdxVal = std::clamp(linearIdxVal, 0.0, 1.0);
+                    linearIdxVal = std::clamp(linearIdxVal, Real(0), Real(1));
 
                     if (parameters.aCurve > 0.0f) {
-                        curveVal = convex[std::clamp((int)(linearIdxVal * 2000.), 0, 1999)];
-                        finalOut = std::clamp((1.0 - parameters.aCurve) * linearIdxVal + parameters.aCurve * curveVal, 0.0, 1.0);
+                        curveVal = curves->convexAt(linearIdxVal);
+                        finalOut = std::clamp((Real(1) - aCurve) * linearIdxVal + aCurve * curveVal, Real(0), Real(1));
                     }
                     else {
-                        curveVal = concave[std::clamp((int)(linearIdxVal * 2000.), 0, 1999)];
-                        finalOut = std::clamp((1.0 + parameters.aCurve) * linearIdxVal - parameters.aCurve * curveVal, 0.0, 1.0);
+                        curveVal = curves->concaveAt(linearIdxVal);
+                        finalOut = std::clamp((Real(1) + aCurve) * linearIdxVal - aCurve * curveVal, Real(0), Real(1));
                     }
 
                     releaseStart = finalOut; // in case note is released before attack finishes
@@ -377,15 +419,15 @@ public:
                 case State::ADRattack:
                 {
                     linearIdxVal += attackRate;
-                    linearIdxVal = std::clamp(linearIdxVal, 0.0, 1.0);
+                    linearIdxVal = std::clamp(linearIdxVal, Real(0), Real(1));
 
                     if (parameters.aCurve > 0.0f) {
-						curveVal = convex[std::clamp((int)(linearIdxVal * 2000.), 0, 1999)];
-                        finalOut = std::clamp((1.0 - parameters.aCurve) * linearIdxVal + parameters.aCurve * curveVal, 0.0, 1.0);
+						curveVal = curves->convexAt(linearIdxVal);
+                        finalOut = std::clamp((Real(1) - aCurve) * linearIdxVal + aCurve * curveVal, Real(0), Real(1));
                     }
                     else {
-                        curveVal = concave[std::clamp((int)(linearIdxVal * 2000.), 0, 1999)];
-                        finalOut = std::clamp((1.0 + parameters.aCurve) * linearIdxVal - parameters.aCurve * curveVal, 0.0, 1.0);
+                        curveVal = curves->concaveAt(linearIdxVal);
+                        finalOut = std::clamp((Real(1) + aCurve) * linearIdxVal - aCurve * curveVal, Real(0), Real(1));
                     }
 
                     releaseStart = finalOut; // in case note is released before attack finishes
@@ -410,21 +452,21 @@ public:
                 case State::decay:
                 {
                     linearIdxVal -= decayRate;
-                    linearIdxVal = std::clamp(linearIdxVal, 0.0, 1.0);
+                    linearIdxVal = std::clamp(linearIdxVal, Real(0), Real(1));
 
                     if (parameters.dRCurve > 0.0) {
-                        curveVal = convex[(int)(linearIdxVal * 2000.)];
-                        unmappedVal = std::clamp(((1.0 - parameters.dRCurve) * linearIdxVal + parameters.dRCurve * curveVal), 0.0, 1.0);
+                        curveVal = curves->convexAt(linearIdxVal);
+                        unmappedVal = std::clamp(((Real(1) - dRCurve) * linearIdxVal + dRCurve * curveVal), Real(0), Real(1));
                     }
                     else {
-                        curveVal = concave[(int)(linearIdxVal * 2000.)];
-                        unmappedVal = std::clamp(((1.0 + parameters.dRCurve) * linearIdxVal - parameters.dRCurve * curveVal), 0.0, 1.0);
+                        curveVal = curves->concaveAt(linearIdxVal);
+                        unmappedVal = std::clamp(((Real(1) + dRCurve) * linearIdxVal - dRCurve * curveVal), Real(0), Real(1));
                     }
                     
-                    finalOut = juce::jmap(unmappedVal, 0.0, 1.0, parameters.sustainLevel, 1.0);
+                    finalOut = juce::jmap(unmappedVal, Real(0), Real(1), sustainLevel, Real(1));
                     releaseStart = finalOut;
 
-                    if (finalOut <= parameters.sustainLevel)
+                    if (finalOut <= sustainLevel)
                     {
                         goToNextState();
                     }
@@ -436,18 +478,18 @@ public:
                 case State::ADRdecay:
                 {
                     linearIdxVal -= decayRate;
-                    linearIdxVal = std::clamp(linearIdxVal, 0.0, 1.0);
+                    linearIdxVal = std::clamp(linearIdxVal, Real(0), Real(1));
 
                     if (parameters.dRCurve > 0.0) {
-                        curveVal = convex[(int)(linearIdxVal * 2000.)];
-                        unmappedVal = std::clamp(((1.0 - parameters.dRCurve) * linearIdxVal + parameters.dRCurve * curveVal), 0.0, 1.0);
+                        curveVal = curves->convexAt(linearIdxVal);
+                        unmappedVal = std::clamp(((Real(1) - dRCurve) * linearIdxVal + dRCurve * curveVal), Real(0), Real(1));
                     }
                     else {
-                        curveVal = concave[(int)(linearIdxVal * 2000.)];
-                        unmappedVal = std::clamp(((1.0 + parameters.dRCurve) * linearIdxVal - parameters.dRCurve * curveVal), 0.0, 1.0);
+                        curveVal = curves->concaveAt(linearIdxVal);
+                        unmappedVal = std::clamp(((Real(1) + dRCurve) * linearIdxVal - dRCurve * curveVal), Real(0), Real(1));
                     }
 
-                    finalOut = juce::jmap(unmappedVal, 0.0, 1.0, parameters.sustainLevel, 1.0);
+                    finalOut = juce::jmap(unmappedVal, Real(0), Real(1), sustainLevel, Real(1));
                     releaseStart = finalOut;
 
                     if (timeSinceStart >= duration)
@@ -455,7 +497,7 @@ public:
                         noteOn();
                     }
 
-                    if (finalOut <= parameters.sustainLevel)
+                    if (finalOut <= sustainLevel)
                     {
                         goToNextState();
                     }
@@ -467,7 +509,7 @@ public:
                 case State::sustain:
                 {
                     linearIdxVal = 1.0;
-                    finalOut = parameters.sustainLevel;
+                    finalOut = sustainLevel;
                     releaseStart = finalOut;
                     break;
                 }
@@ -475,18 +517,18 @@ public:
                 case State::release:
                 {
                     linearIdxVal -= releaseRate;
-                    linearIdxVal = std::clamp(linearIdxVal, 0.0, 1.0);
+                    linearIdxVal = std::clamp(linearIdxVal, Real(0), Real(1));
 
                     if (parameters.dRCurve > 0.0) {
-                        curveVal = convex[std::clamp((int)(linearIdxVal * 2000.), 0, 1999)];
-                        unmappedVal = std::clamp((1.0 - parameters.dRCurve) * linearIdxVal + parameters.dRCurve * curveVal, 0.0, 1.0);
+                        curveVal = curves->convexAt(linearIdxVal);
+                        unmappedVal = std::clamp((Real(1) - dRCurve) * linearIdxVal + dRCurve * curveVal, Real(0), Real(1));
                     }
                     else if (parameters.dRCurve <= 0.0) {
-                        curveVal = concave[std::clamp((int)(linearIdxVal * 2000.), 0, 1999)];
-                        unmappedVal = std::clamp((1.0 + parameters.dRCurve) * linearIdxVal - parameters.dRCurve * curveVal, 0.0, 1.0);
+                        curveVal = curves->concaveAt(linearIdxVal);
+                        unmappedVal = std::clamp((Real(1) + dRCurve) * linearIdxVal - dRCurve * curveVal, Real(0), Real(1));
                     }
 
-                    finalOut = juce::jmap(unmappedVal, 0.0, 1.0, 0.0, releaseStart);
+                    finalOut = juce::jmap(unmappedVal, Real(0), Real(1), Real(0), releaseStart);
                     if (linearIdxVal <= 0.0f)
                         goToNextState();
 
@@ -496,18 +538,18 @@ public:
                 case State::ADRrelease:
                 {
                     linearIdxVal -= releaseRate;
-                    linearIdxVal = std::clamp(linearIdxVal, 0.0, 1.0);
+                    linearIdxVal = std::clamp(linearIdxVal, Real(0), Real(1));
 
                     if (parameters.dRCurve > 0.0) {
-                        curveVal = convex[std::clamp((int)(linearIdxVal * 2000.), 0, 1999)];
-                        unmappedVal = std::clamp((1.0 - parameters.dRCurve) * linearIdxVal + parameters.dRCurve * curveVal, 0.0, 1.0);
+                        curveVal = curves->convexAt(linearIdxVal);
+                        unmappedVal = std::clamp((Real(1) - dRCurve) * linearIdxVal + dRCurve * curveVal, Real(0), Real(1));
                     }
                     else if (parameters.dRCurve <= 0.0) {
-                        curveVal = concave[std::clamp((int)(linearIdxVal * 2000.), 0, 1999)];
-                        unmappedVal = std::clamp((1.0 + parameters.dRCurve) * linearIdxVal - parameters.dRCurve * curveVal, 0.0, 1.0);
+                        curveVal = curves->concaveAt(linearIdxVal);
+                        unmappedVal = std::clamp((Real(1) + dRCurve) * linearIdxVal - dRCurve * curveVal, Real(0), Real(1));
                     }
 
-                    finalOut = juce::jmap(unmappedVal, 0.0, 1.0, 0.0, releaseStart);
+                    finalOut = juce::jmap(unmappedVal, Real(0), Real(1), Real(0), releaseStart);
 
                     if (timeSinceStart >= duration)
                         noteOn();
@@ -538,11 +580,141 @@ public:
     
 private:
     //==============================================================================
+    // lookup tables for the MMA curves, shared by every envelope and built on first use
+    struct CurveTables
+    {
+        static constexpr int size = 2000;
+
+        CurveTables()
+        {
+            for (int i = 1; i < size - 1; i++)
+            {
+                // MMA curve transforms
+                if ( ((double)i / 2000.0) > 0.996 ) // tail ends blow up, so we go linear for last stretch
+                    concave[i] = (float)((double)i / 2000.0);
+                else
+                    concave[i] = (float)std::min(-(5.0 / 12.0) * std::log10(1.0 - (double)i / 2000.0), 1.0);
+
+                if ( ((double)i / 2000.0) < 0.004 ) // negative blow-up
+                    convex[i] = (float)((double)i / 2000.0);
+                else
+                    convex[i] = (float)std::max(1 + (5.0 / 12.0) * std::log10((double)i / 2000.0), 0.0);
+            }
+            concave[0] = 0.f;
+            convex[0] = 0.f;
+            for (int i = size - 1; i <= size; i++) // includes the guard entry for x == 1
+            {
+                concave[i] = 1.f;
+                convex[i] = 1.f;
+            }
+        }
+
+        Real convexAt(Real x) const noexcept { return lookup(convex, x); }
+        Real concaveAt(Real x) const noexcept { return lookup(concave, x); }
+
+        // linear interpolation, x in [0, 1]
+        static Real lookup(const float* table, Real x) noexcept
+        {
+            const Real pos = std::clamp(x, Real(0), Real(1)) * size;
+            const int i = std::min((int)pos, size - 1);
+            return table[i] + (table[i + 1] - table[i]) * (pos - i);
+        }
+
+        float convex[size + 1], concave[size + 1];
+    };
+
+    static const CurveTables& getCurveTables()
+    {
+        static const CurveTables tables;
+        return tables;
+    }
+
+    //==============================================================================
+    // the runs behind renderBlock; each returns how many samples it rendered
+
+    int fill(float* out, int start, int numSamples, Real value) noexcept
+    {
+        finalOut = value;
+        timeSinceStart += (float)inverseSampleRate * (float)numSamples; // only read by the looping states
+        if (out != nullptr)
+            std::fill(out + start, out + start + numSamples, (float)value);
+        return numSamples;
+    }
+
+    // samples until a segment moving by rate from linearIdxVal gets to target,
+    // counting the sample that reaches it
+    int samplesUntil(Real target, Real rate, int numSamples) const noexcept
+    {
+        const double distance = std::abs((double)target - (double)linearIdxVal);
+        if (rate <= Real(0))
+            return numSamples + 1;
+        return (int)std::min((double)numSamples + 1.0, std::max(1.0, std::ceil(distance / (double)rate)));
+    }
+
+    int attackRamp(float* out, int start, int numSamples) noexcept
+    {
+        const int toEnd = samplesUntil(Real(.999), attackRate, numSamples);
+        const int run = std::min(toEnd, numSamples);
+        const Real from = linearIdxVal;
+        if (out != nullptr)
+            for (int i = 0; i < run; i++)
+                out[start + i] = (float)std::min(from + attackRate * Real(i + 1), Real(1));
+
+        linearIdxVal = std::min(from + attackRate * Real(run), Real(1));
+        finalOut = releaseStart = linearIdxVal;
+        timeSinceStart += (float)inverseSampleRate * (float)run;
+        if (run == toEnd)
+        {
+            finalOut = releaseStart = 1.0;
+            if (out != nullptr)
+                out[start + run - 1] = 1.0f;
+            goToNextState();
+        }
+        return run;
+    }
+
+    int decayRamp(float* out, int start, int numSamples) noexcept
+    {
+        const int toEnd = samplesUntil(Real(0), decayRate, numSamples);
+        const int run = std::min(toEnd, numSamples);
+        const Real from = linearIdxVal, sustain = sustainLevel;
+        if (out != nullptr)
+            for (int i = 0; i < run; i++)
+                out[start + i] = (float)(sustain + std::max(from - decayRate * Real(i + 1), Real(0)) * (Real(1) - sustain));
+
+        linearIdxVal = std::max(from - decayRate * Real(run), Real(0));
+        finalOut = releaseStart = sustain + linearIdxVal * (Real(1) - sustain);
+        timeSinceStart += (float)inverseSampleRate * (float)run;
+        if (run == toEnd)
+            goToNextState();
+        return run;
+    }
+
+    int releaseRamp(float* out, int start, int numSamples) noexcept
+    {
+        const int toEnd = samplesUntil(Real(0), releaseRate, numSamples);
+        const int run = std::min(toEnd, numSamples);
+        const Real from = linearIdxVal, level = releaseStart;
+        if (out != nullptr)
+            for (int i = 0; i < run; i++)
+                out[start + i] = (float)(std::max(from - releaseRate * Real(i + 1), Real(0)) * level);
+
+        linearIdxVal = std::max(from - releaseRate * Real(run), Real(0));
+        finalOut = linearIdxVal * level;
+        timeSinceStart += (float)inverseSampleRate * (float)run;
+        if (run == toEnd)
+            goToNextState();
+        return run;
+    }
+
     void recalculateRates() noexcept
     {
-        attackRate = (1.0 / (parameters.attackTimeMs * sampleRate));
-        decayRate = (1.0 / (parameters.decayTimeMs * sampleRate));
-        releaseRate = (1.0 / (parameters.releaseTimeMs * sampleRate));
+        attackRate = Real(1.0 / (parameters.attackTimeMs * sampleRate));
+        decayRate = Real(1.0 / (parameters.decayTimeMs * sampleRate));
+        releaseRate = Real(1.0 / (parameters.releaseTimeMs * sampleRate));
+        sustainLevel = Real(parameters.sustainLevel);
+        aCurve = Real(parameters.aCurve);
+        dRCurve = Real(parameters.dRCurve);
         duration = parameters.syncduration;
         inverseSampleRate = 1.0 / sampleRate;
     }
@@ -599,10 +771,11 @@ private:
 
     double sampleRate = 44100.0;
     double inverseSampleRate = 1.0 / sampleRate;
-    double linearIdxVal{ 0.0 }, curveVal{ 0.0 }, attackRate{ 0.0 }, decayRate{ 0.0 }, releaseRate{ 0.0 }, finalOut{ 0.0 }, unmappedVal{ 0.0 }, releaseStart{ 0.0 };
-    double convex[2000], concave[2000]; // , linear[2002];
+    Real linearIdxVal{ 0 }, curveVal{ 0 }, attackRate{ 0 }, decayRate{ 0 }, releaseRate{ 0 }, finalOut{ 0 }, unmappedVal{ 0 }, releaseStart{ 0 };
+    Real sustainLevel{ 0.5 }, aCurve{ 1 }, dRCurve{ -1 }; // from parameters, in the engine's precision
+    const CurveTables* curves{ &getCurveTables() };
     float timeSinceStart{ 0.f }, duration{ 1.f };
 
 };
 
-
+using Envelope = BasicEnvelope<std::conditional_t<AP_FLOAT_ENVELOPE != 0, float, double>>;
@@ -33,14 +33,14 @@ public:
 
 private:
 	APAudioProcessor& proc;
-	FXBox fxa1Box{ "FX A1", proc},
-		fxa2Box{ "FX A2", proc},
-		fxa3Box{ "FX A3", proc},
-		fxa4Box{ "FX A4", proc},
-		fxb1Box{ "FX B1", proc},
-		fxb2Box{ "FX B2", proc},
-		fxb3Box{ "FX B3", proc},
-		fxb4Box{ "FX B4", proc};
+	FXBox fxa1Box{ "FX A1", proc, 0 },
+		fxa2Box{ "FX A2", proc, 0 },
+		fxa3Box{ "FX A3", proc, 0 },
+		fxa4Box{ "FX A4", proc, 0 },
+		fxb1Box{ "FX B1", proc, 1 },
+		fxb2Box{ "FX B2", proc, 1 },
+		fxb3Box{ "FX B3", proc, 1 },
+		fxb4Box{ "FX B4", proc, 1 };
 	gin::Select chainSetting{ proc.fxOrderParams.chainAtoB };
 	gin::Select fxa1Selector{proc.fxOrderParams.fxa1},
 		fxa2Selector{ proc.fxOrderParams.fxa2 },
@@ -21,8 +21,8 @@
 class FXBox : public gin::ParamBox
 {
 public:
-	FXBox(const juce::String& name, APAudioProcessor& proc_) // gin::Parameter::Ptr box_)
-		: gin::ParamBox(name), proc(proc_), dynamicsMeter(proc.compressor)
+	FXBox(const juce::String& name, APAudioProcessor& proc_, int lane) // gin::Parameter::Ptr box_)
+		: gin::ParamBox(name), proc(proc_), dynamicsMeter(proc.fxLanes[(size_t)lane].compressor)
 	{
 		setName(name);
 		//setTitle(name);
@@ -37,6 +37,7 @@ public:
 		addControl(wstype = new gin::Select(proc.waveshaperParams.type), 1, 2);
 		addControl(wshsfreq = new APKnob(proc.waveshaperParams.highshelf), 2, 0);
 		addControl(wshsq = new APKnob(proc.waveshaperParams.hsq), 2, 1);
+		addControl(wsoversample = new gin::Select(proc.waveshaperParams.oversample), 2, 2);
 
 		// CP = 2
 		addControl(cpthreshold = new APKnob(proc.compressorParams.threshold), 0, 0);
@@ -191,7 +192,7 @@ public:
     void resized() override {
 		gin::ParamBox::resized();
         dynamicsMeter.setBounds(56, 163, 56, 70);
-        funcImage.setBounds(56*2, 23 + 140, 55, 55);
+        funcImage.setBounds(getWidth() - 23, 2, 19, 19); // in the header, leaving the last cell to oversampling
     }
 
 	void setControls(int effect) {
@@ -210,6 +211,7 @@ public:
 			wstype->setVisible(true);
 			wshsfreq->setVisible(true);
 			wshsq->setVisible(true);
+			wsoversample->setVisible(true);
 			paramChanged(); // ensure function image is initialized
             funcImage.setVisible(true);
 			break;
@@ -296,6 +298,7 @@ public:
 		wstype->setVisible(false);
         wshsfreq->setVisible(false);
 		wshsq->setVisible(false);
+		wsoversample->setVisible(false);
 		funcImage.setVisible(false);
 		// CP = 2
 		cpthreshold->setVisible(false);
@@ -360,7 +363,7 @@ public:
 	
     APAudioProcessor& proc;
     gin::ParamComponent::Ptr rmmodfreq1, rmmodfreq2, rmshape1, rmshape2, rmmix1, rmmix2, rmspread, rmlowcut, rmhighcut;
-	gin::ParamComponent::Ptr wsdrive, wsgain, wsdry, wslp, wswet, wstype, wshsfreq, wshsq;
+	gin::ParamComponent::Ptr wsdrive, wsgain, wsdry, wslp, wswet, wstype, wshsfreq, wshsq, wsoversample;
 	gin::ParamComponent::Ptr gngain;
 	gin::ParamComponent::Ptr cpthreshold, cpratio, cpattack, cprelease, cpknee, cpinput, cpoutput, cptype;
 	gin::ParamComponent::Ptr dltimeleft, dltimeright, dlbeatsleft, dlbeatsright, dltemposync, dlfeedback, dldry, dlwet, dlpingpong, dlfreeze, dlcutoff;
@@ -16,12 +16,78 @@
 #include <cmath>
 #include <memory>
 #include <array>
+#include <limits>
+#include <atomic>
 #include <JuceHeader.h>
 #include "LFO.h"
 #include "FastMath.hpp"
 
 #pragma once
 
+// shape a register of samples at a time with the waveshaper's table and polynomial
+// curves; set to 0 to shape every sample with shapeSample, the reference implementation
+#ifndef AP_SIMD_WAVESHAPER
+ #if JUCE_USE_SIMD
+  #define AP_SIMD_WAVESHAPER 1
+ #else
+  #define AP_SIMD_WAVESHAPER 0
+ #endif
+#endif
+
+// How long an effect keeps sounding once its input has gone quiet: feedback
+// effects report their tail from their current settings, so the processor can
+// skip them when they've been fed silence for longer than that.
+namespace EffectTail
+{
+	// a tail that never dies away, e.g. a frozen delay
+	constexpr double infinite = std::numeric_limits<double>::infinity();
+
+	// time for a loop of the given period and gain to die away by 100 dB
+	inline double feedbackTail(double loopSeconds, double gain)
+	{
+		gain = std::abs(gain);
+		if (gain >= 1.0)
+			return infinite;
+		if (gain < 1.0e-5)
+			return loopSeconds;
+		return loopSeconds * (1.0 + std::log(1.0e-5) / std::log(gain));
+	}
+
+	// time for a second-order filter section to ring down by 100 dB: its impulse response
+	// decays as exp(-pi f t / Q), and no faster than a first-order one's exp(-2 pi f t)
+	inline double filterTail(double cutoffHz, double q = 0.70710678)
+	{
+		return std::log(1.0e5) * std::max(q, 0.5) / (juce::MathConstants<double>::pi * std::max(cutoffHz, 1.0));
+	}
+}
+
+// Counts how long an effect's input has been silent, so it can be skipped once
+// that's longer than its tail. Skipping leaves the (silent) block as it is.
+class EffectIdleTracker
+{
+public:
+	static constexpr float silenceThreshold = 1.0e-5f; // -100 dB
+
+	void reset() { silentSamples = 0; }
+
+	// call with each block of input; true when the effect needn't process it
+	bool canSkip(const juce::AudioBuffer<float>& input, double tailSeconds, double sampleRate)
+	{
+		const int numSamples = input.getNumSamples();
+		for (int ch = 0; ch < input.getNumChannels(); ch++) {
+			if (input.getMagnitude(ch, 0, numSamples) >= silenceThreshold) {
+				silentSamples = 0;
+				return false;
+			}
+		}
+		silentSamples += numSamples;
+		return (double)silentSamples > tailSeconds * sampleRate;
+	}
+
+private:
+	juce::int64 silentSamples{ 0 };
+};
+
 class ChorusProcessor 
 {
 public:
@@ -98,6 +164,11 @@ public:
 		delayTime = _delayTime;
 	}
 
+	// the modulated delays never exceed 30 ms
+	double getTailLengthSeconds() const {
+		return EffectTail::feedbackTail(0.03, feedback);
+	}
+
 private:
     float lfoRate{ 0.05f }, depth{ 0.5f }, feedback{ 0.0f }, dry{ 0.5f }, wet{ 0.5f }, delayTime{ 15.f };
     LFO lfo;			///< the modulator
@@ -212,6 +283,13 @@ public:
 		delayBuffer_R.clear();
 	}
 
+	double getTailLengthSeconds() const {
+		if (freeze)
+			return EffectTail::infinite;
+		auto longest = std::min(std::max(delayTimeL.getTargetValue(), delayTimeR.getTargetValue()), 64.0f);
+		return EffectTail::feedbackTail(longest, delayFB);
+	}
+
 private:
     juce::AudioBuffer<float> inBuffer;
     float delayDry{ 1.0f }, delayWet{ 0.5f }, delayFB{ 0.5f };
@@ -275,12 +353,13 @@ public:
 
     static constexpr F kMaxPredelay = 0.1f; // seconds
     static constexpr F kMaxSize = 3.0f;
+    static constexpr int kBlockSize = 256; // longest run for processBlock()
 
     PlateReverb() {}
     ~PlateReverb() {}
 
     // Set the sample rate.  Note that we are re-mallocing all of the various
-    // delay lines here.
+    // delay lines here, as one arena.
     void setSampleRate(F sampleRate_) {
         sampleRate = sampleRate_;
 
@@ -289,7 +368,7 @@ public:
         F r = sampleRate / 29761.0f;
 
         // Predelay
-        predelayLine.reset(new DelayLine((uint32_t)std::ceil(sampleRate * kMaxPredelay)));
+        predelayLine.setSize((uint32_t)std::ceil(sampleRate * kMaxPredelay));
 
         // Lowpass filters
         lowpass.setSampleRate(sampleRate);
@@ -297,10 +376,10 @@ public:
         rightTank.damping.setSampleRate(sampleRate);
 
         // Diffusers
-        diffusers[0].reset(new DelayAllpass((uint32_t)std::ceil(142 * r), 0.75));
-        diffusers[1].reset(new DelayAllpass((uint32_t)std::ceil(107 * r), 0.75));
-        diffusers[2].reset(new DelayAllpass((uint32_t)std::ceil(379 * r), 0.625));
-        diffusers[3].reset(new DelayAllpass((uint32_t)std::ceil(277 * r), 0.625));
+        diffusers[0].setSize((uint32_t)std::ceil(142 * r), 0.75);
+        diffusers[1].setSize((uint32_t)std::ceil(107 * r), 0.75);
+        diffusers[2].setSize((uint32_t)std::ceil(379 * r), 0.625);
+        diffusers[3].setSize((uint32_t)std::ceil(277 * r), 0.625);
 
         // Tanks
         F maxModDepth = 8.0f * kMaxSize * r;
@@ -319,6 +398,23 @@ public:
             (uint32_t)std::ceil(kMaxSize * 3163 * r)       // del2
         );
 
+        // All of the delay memory, in one zeroed block
+        std::array<DelayLine*, 13> lines = {
+            &predelayLine,
+            &diffusers[0].delayLine, &diffusers[1].delayLine, &diffusers[2].delayLine, &diffusers[3].delayLine,
+            &leftTank.apf1.delayLine, &leftTank.del1, &leftTank.apf2.delayLine, &leftTank.del2,
+            &rightTank.apf1.delayLine, &rightTank.del1, &rightTank.apf2.delayLine, &rightTank.del2,
+        };
+        size_t arenaSize = 0;
+        for (auto* line : lines)
+            arenaSize += line->getBufferSize();
+        arena.reset(new F[arenaSize]());
+        F* memory = arena.get();
+        for (auto* line : lines) {
+            line->attach(memory);
+            memory += line->getBufferSize();
+        }
+
         leftTank.lfo.setSampleRate(sampleRate);
         rightTank.lfo.setSampleRate(sampleRate);
         leftTank.lfo.setFrequency(1.0);
@@ -376,7 +472,7 @@ public:
     // extension to the original algorithm.
     void setSize(F sz /* [0, 2] */) {
 
-        F sizeRatio = clamp(sz, 0.0, kMaxSize) / kMaxSize;
+        sizeRatio = clamp(sz, 0.0, kMaxSize) / kMaxSize;
 
         // Scale the tank delays and APFs in each tank
         leftTank.setSizeRatio(sizeRatio);
@@ -397,6 +493,13 @@ public:
         rightTank.damping.setCutoff(cutoff);
     }
 
+    // Each tank's loop is at most 10944 samples at Dattorro's rate, scaled by
+    // size, and loses at least decayRate of its level per trip.
+    double getTailLengthSeconds() const {
+        double loopSeconds = kMaxSize * sizeRatio * 10944.0 / 29761.0;
+        return predelay / sampleRate + EffectTail::feedbackTail(loopSeconds, decayRate);
+    }
+
     void prepare(juce::dsp::ProcessSpec spec) {
         sampleRate = (float)spec.sampleRate;
 		setSampleRate(sampleRate);
@@ -406,16 +509,66 @@ public:
     void process(juce::dsp::ProcessContextReplacing<float> context) {
         auto& inBlock = context.getOutputBlock();
 
-		auto numSamples = inBlock.getNumSamples();
-		auto outLeft = inBlock.getChannelPointer(0);
-		auto outRight = inBlock.getChannelPointer(1);
-		auto inLeft = inBlock.getChannelPointer(0);
-		auto inRight = inBlock.getChannelPointer(1);
-		for (int i = 0; i < static_cast<int>(numSamples); i++) {
-			process(inLeft[i], inRight[i], &outLeft[i], &outRight[i]);
+		auto numSamples = static_cast<int>(inBlock.getNumSamples());
+		auto left = inBlock.getChannelPointer(0);
+		auto right = inBlock.getChannelPointer(1);
+		for (int start = 0; start < numSamples; start += kBlockSize) {
+			processBlock(left + start, right + start, std::min(kBlockSize, numSamples - start));
 		}
     }
 
+    // Process up to kBlockSize samples in place.  The same as calling
+    // process() below for each sample, but the stages that don't feed back
+    // run over the whole block at once.
+    void processBlock(F* left, F* right, int numSamples) {
+        jassert(numSamples <= kBlockSize);
+
+        // Synthetic stereo, as below
+        for (int i = 0; i < numSamples; i++)
+            input[(size_t)i] = left[i] + right[i];
+
+        // Predelay, input lowpass and diffusers, a stage at a time
+        predelayLine.tapAndPushBlock(predelay, input.data(), numSamples);
+        for (int i = 0; i < numSamples; i++)
+            input[(size_t)i] = lowpass.process(input[(size_t)i]);
+        for (auto& diffuser : diffusers)
+            diffuser.processBlock(input.data(), numSamples, (F)diffuser.getSize());
+
+        // The tanks feed each other, so they go a sample at a time
+        for (int i = 0; i < numSamples; i++) {
+            F leftIn = input[(size_t)i] + rightTank.out * decayRate;
+            F rightIn = input[(size_t)i] + leftTank.out * decayRate;
+            leftTank.process(leftIn);
+            rightTank.process(rightIn);
+        }
+
+        // Tap for output, a tap at a time over the samples just written
+        std::fill(wetLeft.begin(), wetLeft.begin() + numSamples, F(0));
+        std::fill(wetRight.begin(), wetRight.begin() + numSamples, F(0));
+
+        rightTank.del1.addTaps(wetLeft.data(), leftTaps[0], 1, numSamples);            //  266
+        rightTank.del1.addTaps(wetLeft.data(), leftTaps[1], 1, numSamples);            // 2974
+        rightTank.apf2.delayLine.addTaps(wetLeft.data(), leftTaps[2], -1, numSamples); // 1913
+        rightTank.del2.addTaps(wetLeft.data(), leftTaps[3], 1, numSamples);            // 1996
+        leftTank.del1.addTaps(wetLeft.data(), leftTaps[4], -1, numSamples);            // 1990
+        leftTank.apf2.delayLine.addTaps(wetLeft.data(), leftTaps[5], -1, numSamples);  //  187
+        leftTank.del2.addTaps(wetLeft.data(), leftTaps[6], -1, numSamples);            // 1066
+
+        leftTank.del1.addTaps(wetRight.data(), rightTaps[0], 1, numSamples);             //  353
+        leftTank.del1.addTaps(wetRight.data(), rightTaps[1], 1, numSamples);             // 3627
+        leftTank.apf2.delayLine.addTaps(wetRight.data(), rightTaps[2], -1, numSamples);  // 1228
+        leftTank.del2.addTaps(wetRight.data(), rightTaps[3], 1, numSamples);             // 2673
+        rightTank.del1.addTaps(wetRight.data(), rightTaps[4], -1, numSamples);           // 2111
+        rightTank.apf2.delayLine.addTaps(wetRight.data(), rightTaps[5], -1, numSamples); //  335
+        rightTank.del2.addTaps(wetRight.data(), rightTaps[6], -1, numSamples);           //  121
+
+        // Mix
+        for (int i = 0; i < numSamples; i++) {
+            left[i] = left[i] * dry + wetLeft[(size_t)i] * wet;
+            right[i] = right[i] * dry + wetRight[(size_t)i] * wet;
+        }
+    }
+
     // Process a stereo pair of samples.
     void process(F dryLeft, F dryRight, F* leftOut, F* rightOut) {
 
@@ -426,16 +579,16 @@ public:
         F sum = dryLeft + dryRight;
 
         // Predelay
-        sum = predelayLine->tapAndPush(predelay, sum);
+        sum = predelayLine.tapAndPush(predelay, sum);
 
         // Input lowpass
         sum = lowpass.process(sum);
 
         // Diffusers
-        sum = diffusers[0]->process(sum, diffusers[0]->getSize());
-        sum = diffusers[1]->process(sum, diffusers[1]->getSize());
-        sum = diffusers[2]->process(sum, diffusers[2]->getSize());
-        sum = diffusers[3]->process(sum, diffusers[3]->getSize());
+        sum = diffusers[0].process(sum, diffusers[0].getSize());
+        sum = diffusers[1].process(sum, diffusers[1].getSize());
+        sum = diffusers[2].process(sum, diffusers[2].getSize());
+        sum = diffusers[3].process(sum, diffusers[3].getSize());
 
         // Tanks
         F leftIn = sum + rightTank.out * decayRate;
@@ -444,25 +597,25 @@ public:
         rightTank.process(rightIn);
 
         // Tap for output
-        F wetLeft = rightTank.del1->tap(leftTaps[0])   //  266
-            + rightTank.del1->tap(leftTaps[1]) // 2974
-            - rightTank.apf2->tap(leftTaps[2]) // 1913
-            + rightTank.del2->tap(leftTaps[3]) // 1996
-            - leftTank.del1->tap(leftTaps[4])  // 1990
-            - leftTank.apf2->tap(leftTaps[5])  //  187
-            - leftTank.del2->tap(leftTaps[6]); // 1066
-
-        F wetRight = leftTank.del1->tap(rightTaps[0])     //  353
-            + leftTank.del1->tap(rightTaps[1])   // 3627
-            - leftTank.apf2->tap(rightTaps[2])   // 1228
-            + leftTank.del2->tap(rightTaps[3])   // 2673
-            - rightTank.del1->tap(rightTaps[4])  // 2111
-            - rightTank.apf2->tap(rightTaps[5])  //  335
-            - rightTank.del2->tap(rightTaps[6]); //  121
+        F tapLeft = rightTank.del1.tap(leftTaps[0])   //  266
+            + rightTank.del1.tap(leftTaps[1]) // 2974
+            - rightTank.apf2.tap(leftTaps[2]) // 1913
+            + rightTank.del2.tap(leftTaps[3]) // 1996
+            - leftTank.del1.tap(leftTaps[4])  // 1990
+            - leftTank.apf2.tap(leftTaps[5])  //  187
+            - leftTank.del2.tap(leftTaps[6]); // 1066
+
+        F tapRight = leftTank.del1.tap(rightTaps[0])     //  353
+            + leftTank.del1.tap(rightTaps[1])   // 3627
+            - leftTank.apf2.tap(rightTaps[2])   // 1228
+            + leftTank.del2.tap(rightTaps[3])   // 2673
+            - rightTank.del1.tap(rightTaps[4])  // 2111
+            - rightTank.apf2.tap(rightTaps[5])  //  335
+            - rightTank.del2.tap(rightTaps[6]); //  121
 
         // Mix
-        *leftOut = dryLeft * dry + wetLeft * wet;
-        *rightOut = dryRight * dry + wetRight * wet;
+        *leftOut = dryLeft * dry + tapLeft * wet;
+        *rightOut = dryRight * dry + tapRight * wet;
     }
 
 private:
@@ -516,26 +669,30 @@ private:
 
     public:
 
-        DelayLine(I size_) : size(size_) {
-
-            // For speed, create a bigger buffer than we really need.
-            I bufferSize = ceilPowerOfTwo(size);
-            buffer.reset(new F[bufferSize]);
-            std::memset(&buffer[0], 0, bufferSize * sizeof(F));
+        DelayLine() {}
+        ~DelayLine() {}
 
-            mask = bufferSize - 1;
+        // Set the longest delay.  For speed, the buffer is a power of two,
+        // with room for a block's worth of taps behind the longest delay.
+        void setSize(I size_) {
+            size = size_;
+            mask = ceilPowerOfTwo(size + kBlockSize + 2) - 1;
+        }
 
+        // Use getBufferSize() samples of the given memory as the buffer.
+        void attach(F* memory) {
+            buffer = memory;
             writeIdx = 0;
         }
 
-        ~DelayLine() {}
+        inline I getBufferSize() const { return mask + 1; }
 
         inline void push(F val) {
             buffer[writeIdx++] = val;
             writeIdx &= mask;
         }
 
-        inline F tap(F delay /* samples */) {
+        inline F tap(F delay /* samples */) const {
             // We always want to be able to properly handle any delay value that
             // gets passed in here, without going past the original size.
             jassert(delay <= size);
@@ -557,16 +714,38 @@ private:
             return out;
         }
 
-        inline I getSize() { return size; }
+        // tapAndPush() for each sample in place.
+        void tapAndPushBlock(F delay, F* vals, int numSamples) {
+            for (int i = 0; i < numSamples; i++)
+                vals[i] = tapAndPush(delay, vals[i]);
+        }
+
+        // Add gain * tap(delay) to out[i], as tap() would have returned it
+        // just after the i'th of the last numSamples pushes.
+        void addTaps(F* out, F delay, F gain, int numSamples) const {
+            jassert(delay <= size && numSamples <= kBlockSize);
+
+            I d = (uint32_t)delay;
+            F frac = 1 - (delay - d);
+
+            I readIdx = (writeIdx - 1) - d - (I)(numSamples - 1);
+            for (int i = 0; i < numSamples; i++, readIdx++) {
+                F a = buffer[(readIdx - 1) & mask];
+                F b = buffer[readIdx & mask];
+                out[i] += gain * (a + (b - a) * frac);
+            }
+        }
+
+        inline I getSize() const { return size; }
 
     private:
 
-        const I size;
+        I size = 0;
 
-        std::unique_ptr<F[]> buffer;
-        I mask;
+        F* buffer = nullptr; // in the reverb's arena
+        I mask = 0;
 
-        I writeIdx;
+        I writeIdx = 0;
 
         static I ceilPowerOfTwo(I n) {
             return (I)std::pow(2, std::ceil(std::log(n) / std::log(2)));
@@ -581,10 +760,14 @@ private:
 
     public:
 
-        DelayAllpass(I size_, F gain_) : delayLine(size_), gain(gain_) {}
-
+        DelayAllpass() {}
         ~DelayAllpass() {}
 
+        void setSize(I size_, F gain_) {
+            delayLine.setSize(size_);
+            gain = gain_;
+        }
+
         inline F process(F x, F delay) {
             F wd = delayLine.tap(delay);
             F w = x + gain * wd;
@@ -593,16 +776,23 @@ private:
             return y;
         }
 
+        // process() for each sample in place.
+        void processBlock(F* x, int numSamples, F delay) {
+            for (int i = 0; i < numSamples; i++)
+                x[i] = process(x[i], delay);
+        }
+
         inline void setGain(F gain_) { gain = gain_; }
 
-        inline F tap(F delay) { return delayLine.tap(delay); }
+        inline F tap(F delay) const { return delayLine.tap(delay); }
 
-        inline I getSize() { return delayLine.getSize(); }
+        inline I getSize() const { return delayLine.getSize(); }
+
+        DelayLine delayLine;
 
     private:
 
-        DelayLine delayLine;
-        F gain;
+        F gain = 0;
     };
 
     //--------------------------------------------------------------
@@ -672,11 +862,11 @@ private:
             apf1Size = apf1Size_;
             maxModDepth = maxModDepth_;
             F maxApf1Size = apf1Size + maxModDepth + 1;
-            apf1.reset(new DelayAllpass((uint32_t)maxApf1Size, apf1Gain_));
+            apf1.setSize((uint32_t)maxApf1Size, apf1Gain_);
 
-            del1.reset(new DelayLine(delay1Size_));
-            apf2.reset(new DelayAllpass(apf2Size_, apf2Gain_));
-            del2.reset(new DelayLine(delay2Size_));
+            del1.setSize(delay1Size_);
+            apf2.setSize(apf2Size_, apf2Gain_);
+            del2.setSize(delay2Size_);
 
             // We've changed the various delay line sizes and associated values,
             // so update the sizeRatio values too.
@@ -685,7 +875,7 @@ private:
 
         void setDecay(F decayRate_) {
             decayRate = decayRate_;
-            apf2->setGain(clamp(decayRate + 0.15f, 0.25f, 0.5f));
+            apf2.setGain(clamp(decayRate + 0.15f, 0.25f, 0.5f));
         }
 
         void setSizeRatio(F sizeRatio_) {
@@ -696,25 +886,25 @@ private:
         void process(F val) {
 
             // APF1: "Controls density of tail."
-            val = apf1->process(val, apf1Delay + lfo.process() * modDepth);
-            val = del1->tapAndPush(del1Delay, val);
+            val = apf1.process(val, apf1Delay + lfo.process() * modDepth);
+            val = del1.tapAndPush(del1Delay, val);
 
             val = damping.process(val);
             val *= decayRate;
 
             // APF2: "Decorrelates tank signals."
-            val = apf2->process(val, apf2Delay);
-            val = del2->tapAndPush(del2Delay, val);
+            val = apf2.process(val, apf2Delay);
+            val = del2.tapAndPush(del2Delay, val);
 
             out = val;
         }
 
         F out = 0.0;
 
-        std::unique_ptr<DelayAllpass> apf1 = nullptr;
-        std::unique_ptr<DelayAllpass> apf2 = nullptr;
-        std::unique_ptr<DelayLine> del1 = nullptr;
-        std::unique_ptr<DelayLine> del2 = nullptr;
+        DelayAllpass apf1;
+        DelayAllpass apf2;
+        DelayLine del1;
+        DelayLine del2;
         OnePoleFilter damping;
         Lfo lfo;
 
@@ -737,9 +927,9 @@ private:
             apf1Delay = apf1Size * sizeRatio;
             modDepth = maxModDepth * sizeRatio;
 
-            apf2Delay = apf2->getSize() * sizeRatio;
-            del1Delay = del1->getSize() * sizeRatio;
-            del2Delay = del2->getSize() * sizeRatio;
+            apf2Delay = apf2.getSize() * sizeRatio;
+            del1Delay = del1.getSize() * sizeRatio;
+            del2Delay = del2.getSize() * sizeRatio;
         }
     };
 
@@ -753,11 +943,12 @@ private:
     F wet = 0.0;
     F predelay = 0.0;
     F decayRate = 0.0;
+    F sizeRatio = 1.0;
 
-    std::unique_ptr<DelayLine> predelayLine = nullptr;
+    std::unique_ptr<F[]> arena; // memory for every delay line
+    DelayLine predelayLine;
     OnePoleFilter lowpass;
-    std::array<std::unique_ptr<DelayAllpass>, 4> diffusers = {
-        nullptr, nullptr, nullptr, nullptr };
+    std::array<DelayAllpass, 4> diffusers;
 
     Tank leftTank;
     Tank rightTank;
@@ -768,6 +959,11 @@ private:
     std::array<F, kNumTaps> leftTaps = {};
     std::array<F, kNumTaps> rightTaps = {};
 
+    // Working storage for processBlock()
+    std::array<F, kBlockSize> input = {};
+    std::array<F, kBlockSize> wetLeft = {};
+    std::array<F, kBlockSize> wetRight = {};
+
     static inline F clamp(F val, F low, F high) {
         return std::min(std::max(val, low), high);
     }
@@ -838,9 +1034,17 @@ public:
 		iirHSFrequency = HSFreq;
 		iirHSGain = HSGain;
         iirHSQ = HSQ;
-        *iirLS.state  = *juce::dsp::IIR::Coefficients<float>::makeLowShelf(currentSampleRate, iirLSFrequency, iirLSQ, iirLSGain);
-        *iirPeak.state = *juce::dsp::IIR::Coefficients<float>::makePeakFilter(currentSampleRate, iirPeakFrequency, iirPeakQ, iirPeakGain);
-        *iirHS.state  = *juce::dsp::IIR::Coefficients<float>::makeHighShelf(currentSampleRate, iirHSFrequency, iirHSQ, iirHSGain);
+        // called every block: ArrayCoefficients fills the existing coefficients without allocating
+        *iirLS.state  = juce::dsp::IIR::ArrayCoefficients<float>::makeLowShelf(currentSampleRate, iirLSFrequency, iirLSQ, iirLSGain);
+        *iirPeak.state = juce::dsp::IIR::ArrayCoefficients<float>::makePeakFilter(currentSampleRate, iirPeakFrequency, iirPeakQ, iirPeakGain);
+        *iirHS.state  = juce::dsp::IIR::ArrayCoefficients<float>::makeHighShelf(currentSampleRate, iirHSFrequency, iirHSQ, iirHSGain);
+	}
+
+	// the band that rings longest, usually the low shelf
+	double getTailLengthSeconds() const {
+		return std::max({ EffectTail::filterTail(iirLSFrequency, iirLSQ),
+			EffectTail::filterTail(iirPeakFrequency, iirPeakQ),
+			EffectTail::filterTail(iirHSFrequency, iirHSQ) });
 	}
 
 private:
@@ -863,12 +1067,23 @@ class WaveShaperProcessor
 public:
     WaveShaperProcessor() {
         setFunctionToUse(0);
+		// one for each factor, built up front so switching between them doesn't allocate
+		for (size_t i = 0; i < oversamplers.size(); i++)
+			oversamplers[i] = std::make_unique<juce::dsp::Oversampling<float>>(2, i + 1,
+				juce::dsp::Oversampling<float>::filterHalfBandFIREquiripple, true, true);
     }
     ~WaveShaperProcessor() = default;
 
     void prepare(juce::dsp::ProcessSpec spec)
     {
         sampleRate = spec.sampleRate;
+		inBuffer.setSize(2, (int)spec.maximumBlockSize);
+		for (auto& oversampler : oversamplers)
+			oversampler->initProcessing(spec.maximumBlockSize);
+		dryDelay.setMaximumDelayInSamples(getMaxLatencySamples() + 1);
+		dryDelay.prepare(spec);
+		dryDelay.setDelay((float)getLatencySamples());
+		activeOrder = oversampleOrder.load();
 
         // see https://signalsmith-audio.co.uk/writing/2022/warm-distortion/
 		*preBoost.state = *juce::dsp::IIR::Coefficients<float>::makeHighShelf(sampleRate, 6500.f, 1.0f, 63.0f);
@@ -884,7 +1099,7 @@ public:
 		preBoost.prepare(spec);
 		postCut.prepare(spec);
 		lowPassPostWet.prepare(spec);
-		*highPassPost.state = *juce::dsp::IIR::Coefficients<float>::makeHighPass(sampleRate, 5.0f);
+		*highPassPost.state = *juce::dsp::IIR::Coefficients<float>::makeHighPass(sampleRate, highPassCutoff);
 		highPassPost.prepare(spec);
 	}
 
@@ -897,13 +1112,48 @@ public:
 		float cutoff = lowPassPostWetCutoff.getCurrentValue();
 		lowPassPostWet.setCutoffFrequency(cutoff);
 		
+		// wet = lowpass(shape(preGain(dry))), a stage at a time over the whole block;
+		// when oversampling, only the shaping runs at the higher rate, and the dry
+		// signal is delayed to line up with the wet signal coming out of the filters
+		const int order = oversampleOrder.load();
+		if (order != activeOrder) { // a new setting starts from clean filters
+			if (order > 0) {
+				oversamplers[(size_t)order - 1]->reset();
+				dryDelay.setDelay((float)oversamplers[(size_t)order - 1]->getLatencyInSamples());
+			}
+			dryDelay.reset();
+			activeOrder = order;
+		}
 		auto* dataL = context.getOutputBlock().getChannelPointer(0);
 		auto* dataR = context.getOutputBlock().getChannelPointer(1);
-		for (int i = 0; i < numSamples; i++) {
-			float left = dataL[i];
-			float right = dataR[i];
-			dataL[i] = lowPassPostWet.processSample(0, useFunction(preGain.processSample(left))) * wet + left * dry;
-			dataR[i] = lowPassPostWet.processSample(1, useFunction(preGain.processSample(right))) * wet + right * dry;
+		for (int start = 0; start < numSamples; start += inBuffer.getNumSamples()) {
+			const int n = std::min(numSamples - start, inBuffer.getNumSamples());
+			auto* wetL = inBuffer.getWritePointer(0);
+			auto* wetR = inBuffer.getWritePointer(1);
+			juce::FloatVectorOperations::copy(wetL, dataL + start, n);
+			juce::FloatVectorOperations::copy(wetR, dataR + start, n);
+
+			auto wetBlock = juce::dsp::AudioBlock<float>(inBuffer).getSubBlock(0, (size_t)n);
+			auto wetContext = juce::dsp::ProcessContextReplacing<float>(wetBlock);
+			preGain.process(wetContext);
+			if (order > 0) {
+				auto& oversampler = *oversamplers[(size_t)order - 1];
+				auto upBlock = oversampler.processSamplesUp(wetBlock);
+				shapeBlock(upBlock.getChannelPointer(0), upBlock.getChannelPointer(1), (int)upBlock.getNumSamples());
+				oversampler.processSamplesDown(wetBlock);
+
+				auto dryBlock = context.getOutputBlock().getSubBlock((size_t)start, (size_t)n);
+				dryDelay.process(juce::dsp::ProcessContextReplacing<float>(dryBlock));
+			}
+			else {
+				shapeBlock(wetL, wetR, n);
+			}
+			lowPassPostWet.process(wetContext);
+
+			for (auto [out, in] : { std::pair(dataL + start, wetL), std::pair(dataR + start, wetR) }) {
+				juce::FloatVectorOperations::multiply(out, dry, n);
+				juce::FloatVectorOperations::addWithMultiply(out, in, wet, n);
+			}
 		}
 		
 		postCut.process(context); // high shelf
@@ -927,12 +1177,41 @@ public:
 	{
         preGain.reset();
 		postGain.reset();
+		for (auto& oversampler : oversamplers)
+			oversampler->reset();
+		dryDelay.reset();
+	}
+
+	// 0 for none, or 1-3 for 2x, 4x or 8x
+	// safe from any thread; process() switches over at the start of its next block
+	void setOversampling(int order)
+	{
+		oversampleOrder = std::clamp(order, 0, (int)oversamplers.size());
+	}
+
+	// in samples at the base rate, for the latest setting; the oversampling filters are the only source
+	int getLatencySamples() const
+	{
+		const int order = oversampleOrder.load();
+		return order > 0 ? (int)oversamplers[(size_t)order - 1]->getLatencyInSamples() : 0;
+	}
+
+	// at the highest oversampling factor
+	int getMaxLatencySamples() const
+	{
+		return (int)oversamplers.back()->getLatencyInSamples();
 	}
 	
+	// the DC-blocking high pass after the shaper rings longest; the oversampling filters
+	// add their latency on top
+	double getTailLengthSeconds() const {
+		return EffectTail::filterTail(highPassCutoff) + getLatencySamples() / sampleRate;
+	}
+
 	void setHighShelfFreqAndQ(float freq, float q) {
-		*preBoost.state= *juce::dsp::IIR::Coefficients<float>::makeHighShelf(sampleRate, freq, q, 63.0f);
+		*preBoost.state= juce::dsp::IIR::ArrayCoefficients<float>::makeHighShelf(sampleRate, freq, q, 63.0f);
 		//*preBoostR.coefficients = *juce::dsp::IIR::Coefficients<float>::makeHighShelf(sampleRate, freq, q, 63.0f);
-		*postCut.state= *juce::dsp::IIR::Coefficients<float>::makeHighShelf(sampleRate, freq, q, 0.015849f);
+		*postCut.state= juce::dsp::IIR::ArrayCoefficients<float>::makeHighShelf(sampleRate, freq, q, 0.015849f);
 		//*postCutR.coefficients = *juce::dsp::IIR::Coefficients<float>::makeHighShelf(sampleRate, freq, q, 0.015849f);
 	}
 
@@ -941,159 +1220,172 @@ public:
 		currentFunction = function;
     }
 
-	float useFunction(float x) {
-		switch (currentFunction)
-		{
-		case 0:	// sine
-			if (std::abs(x) <= 1.f)
-				return std::sin(juce::MathConstants<float>::halfPi * x);
-			else if (x > 1.f)
-				return 1.f;
-			else //if (x < -1.f)
-				return -1.f;
-			break;
-		case 1: // atan 2
-			if (std::abs(x) <= 1.f)
-				return std::atan(2.f * x) / 1.10714871779409f;
-			else if (x > 1.f)
-				return 1.f;
-			else //if (x < -1.f)
-				return -1.f;
-			break;
-		case 2: // atan 4
-			if (std::abs(x) <= 1.f)
-				return std::atan(4.f * x) / 1.32581766366803f;
-			else if (x > 1.f)
-				return 1.f;
-			else //if (x < -1.f)
-				return -1.f;
-			break;
-		case 3: // atan 6
-			if (std::abs(x) <= 1.f)
-				return std::atan(6.f * x) / 1.40564764938027f;
-			else if (x > 1.f)
-				return 1.f;
-			else //if (x < -1.f)
-				return -1.f;
-			break;
-		case 4: // tanh 2
-			if (std::abs(x) <= 1.f)
-				return std::tanh(2.f * x) / 0.964027580075817f;
-			else if (x > 1.f)
-				return 1.f;
-			else //if (x < -1.f)
-				return -1.f;
-			break;
-		case 5: // tanh 4
-			if (std::abs(x) <= 1.f)
-				return std::tanh(4.f * x) / 0.999329299739067f;
-			else if (x > 1.f)
-				return 1.f;
-			else //if (x < -1.f)
-				return -1.f;
-			break;
-		case 6: // tanh 6
-			if (std::abs(x) <= 1.f)
-				return std::tanh(6.f * x) / 0.999987711650796f;
-			else if (x > 1.f)
-				return 1.f;
-			else //if (x < -1.f)
-				return -1.f;
-			break;
-		case 7: // cubic mid
-			if (std::abs(x) <= 1.f)
-				return (x + x * x * x) * 0.5f;
-			else if (x > 1.f)
-				return 1.f;
-			else //if (x < -1.f)
-				return -1.f;
-			break;
-		case 8: // cubic
-			if (std::abs(x) <= 1.f)
-				return x * x * x;
-			else if (x > 1.f)
-				return 1.f;
-			else //if (x < -1.f)
-				return -1.f;
-			break;
-		case 9: // cheb3
-			if (std::abs(x) <= 1.f)
-				return -(4.f * x * x * x - 3.f * x); // negative, so dry and wet don't interfere
-			else if (x > 1.f)
-				return -1.f; // flipped for continuity with above
-			else //if (x < -1.f)
-				return 1.f;
-			break;
-		case 10: // cheb5
-			if (std::abs(x) <= 1.f)
-				return 16.f * x * x * x * x * x - 20.f * x * x * x + 5.f * x;
-			else if (x > 1.f)
-				return 1.f;
-			else //if (x < -1.f)
-				return -1.f;
-			break;
-		case 11: // "halfwave"
-			if (x > 0.f && x < 1.f)
-				return std::tanh(1.5f * x) * 1.10479139298f; // 1.104 term is 1/tanh(1.5)
-			else if (x > 1.f)
-				return 1.f;
-			else //if (x < -1.f)
-				return 0.f;
-			break;
-		case 12: // "clipping"
-			if (x < -0.7f)
-				return -1.f;
-			else if (x > 0.7f)
-				return 1.f;
-			else
-				return x * 1.42857142857f;
-			break;
-		case 13: // "bitcrush"
+	// the transfer function for one sample; the cheap curves are evaluated directly,
+	// clamped to [-1, 1] first where they saturate outside it, and the ones that need
+	// transcendentals are read from tables
+	template <int function>
+	float shapeSample(float x) noexcept {
+		const float c = std::clamp(x, -1.f, 1.f);
+		if constexpr (function == 0) // sine
+			return FastMath<float>::minimaxSinInRange(juce::MathConstants<float>::halfPi * c);
+		else if constexpr (function == 1) // atan 2
+			return ShaperTables::lookup(tables->atan2, x);
+		else if constexpr (function == 2) // atan 4
+			return ShaperTables::lookup(tables->atan4, x);
+		else if constexpr (function == 3) // atan 6
+			return ShaperTables::lookup(tables->atan6, x);
+		else if constexpr (function == 4) // tanh 2
+			return ShaperTables::lookup(tables->tanh2, x);
+		else if constexpr (function == 5) // tanh 4
+			return ShaperTables::lookup(tables->tanh4, x);
+		else if constexpr (function == 6) // tanh 6
+			return ShaperTables::lookup(tables->tanh6, x);
+		else if constexpr (function == 7) // cubic mid
+			return (c + c * c * c) * 0.5f;
+		else if constexpr (function == 8) // cubic
+			return c * c * c;
+		else if constexpr (function == 9) // cheb3
+			return -(4.f * c * c * c - 3.f * c); // negative, so dry and wet don't interfere
+		else if constexpr (function == 10) // cheb5
+			return 16.f * c * c * c * c * c - 20.f * c * c * c + 5.f * c;
+		else if constexpr (function == 11) // "halfwave", which is 1 at x = 1 like the curve either side of it
+			return ShaperTables::lookup(tables->halfwave, x);
+		else if constexpr (function == 12) // "clipping"
+			return std::clamp(x * 1.42857142857f, -1.f, 1.f);
+		else if constexpr (function == 13) { // "bitcrush"
 			if (std::abs(x) < 0.01f)
 				return 0.f;
-			else {
-				float steps = 8.f - 7.f * (drive / 60.f);
-				return std::floor(steps * std::atan(2.f * x) * 0.903221025259f) / steps;
+			return std::floor(bitcrushSteps * ShaperTables::atanAnywhere(2.f * x) * 0.903221025259f) / bitcrushSteps;
+		}
+		else if constexpr (function == 14) { // "noise", x * |p|^(1 - drive / 80) with p's sign
+			if (std::abs(x) > 1.f)
+				return c;
+			const float p = pinkNoise.nextSample();
+			float amount;
+			if (std::abs(p) <= 1.f) { // the tables run over |p|^(1/4), and between whole dB of drive
+				const float u = std::sqrt(std::sqrt(std::abs(p)));
+				const float a = ShaperTables::lookupUnipolar(noiseCurve, ShaperTables::noiseSize, u);
+				amount = a + (ShaperTables::lookupUnipolar(noiseCurve + ShaperTables::noiseSize + 1, ShaperTables::noiseSize, u) - a) * noiseDriveFraction;
 			}
-			break;
-		case 14: // "noise"
-			if (std::abs(x) <= 1.f) {
-				float p = pinkNoise.nextSample();
-				float factor = 1.f - (drive / 80.f);
-				if (p >= 0.f)
-					return jlimit(-1.f, 1.f, x * std::pow(p, factor));
-				else
-					return jlimit(-1.f, 1.f, x * -std::pow(-p, factor));
+			else {
+				amount = std::pow(std::abs(p), 1.f - drive / 80.f);
 			}
-			else
-                return jlimit(-1.f, 1.f, x);
-			break;
-        case 15: // "fullwave"
-            if (x < 0.f) {
-                return -std::tanh(3.f*x) * 0.99505475368f; // tanh(3x)/tanh(3)
-            }
-            else {
-                return std::tanh(3.f*x) * 0.99505475368f;
-            }
-            break;
-        case 16: // "wavefolder"
-            return 4 * (std::abs(0.5f * x + 0.25f - std::round(0.5f * x + 0.25f)) - 0.25f);
-            break;
-		default:
+			return jlimit(-1.f, 1.f, x * (p >= 0.f ? amount : -amount));
+		}
+		else if constexpr (function == 15) // "fullwave", tanh(3|x|) / tanh(3)
+			return ShaperTables::lookupUnipolar(tables->fullwave, ShaperTables::size, std::abs(x) * 0.25f);
+		else if constexpr (function == 16) // "wavefolder"
+			return 4 * (std::abs(0.5f * x + 0.25f - std::round(0.5f * x + 0.25f)) - 0.25f);
+		else
+			return x;
+	}
+
+	// the curves with a register kernel: the tables, and the polynomials and clip that
+	// only need arithmetic and a clamp
+	static constexpr bool hasRegisterKernel(int function) {
+		return (function >= 0 && function <= 12) || function == 15;
+	}
+
+	// shapeSample for a register of samples, with the same arithmetic in the same order;
+	// only the table reads are done a lane at a time
+	template <int function>
+	juce::dsp::SIMDRegister<float> shapeRegister(juce::dsp::SIMDRegister<float> x) const noexcept {
+		using Reg = juce::dsp::SIMDRegister<float>;
+		const Reg c = Reg::min(Reg::max(x, Reg(-1.f)), Reg(1.f));
+		if constexpr (function == 0) // sine
+			return FastMath<float>::simdSin(Reg(juce::MathConstants<float>::halfPi) * c);
+		else if constexpr (function == 1)
+			return ShaperTables::lookup(tables->atan2, x);
+		else if constexpr (function == 2)
+			return ShaperTables::lookup(tables->atan4, x);
+		else if constexpr (function == 3)
+			return ShaperTables::lookup(tables->atan6, x);
+		else if constexpr (function == 4)
+			return ShaperTables::lookup(tables->tanh2, x);
+		else if constexpr (function == 5)
+			return ShaperTables::lookup(tables->tanh4, x);
+		else if constexpr (function == 6)
+			return ShaperTables::lookup(tables->tanh6, x);
+		else if constexpr (function == 7) // cubic mid
+			return (c + c * c * c) * Reg(0.5f);
+		else if constexpr (function == 8) // cubic
+			return c * c * c;
+		else if constexpr (function == 9) // cheb3, as 3c - 4c^3, which is -(4c^3 - 3c) exactly
+			return Reg(3.f) * c - Reg(4.f) * c * c * c;
+		else if constexpr (function == 10) // cheb5
+			return Reg(16.f) * c * c * c * c * c - Reg(20.f) * c * c * c + Reg(5.f) * c;
+		else if constexpr (function == 11) // "halfwave"
+			return ShaperTables::lookup(tables->halfwave, x);
+		else if constexpr (function == 12) // "clipping"
+			return Reg::min(Reg::max(x * Reg(1.42857142857f), Reg(-1.f)), Reg(1.f));
+		else if constexpr (function == 15) // "fullwave"
+			return ShaperTables::lookupUnipolar(tables->fullwave, ShaperTables::size, Reg::abs(x) * Reg(0.25f));
+		else
 			return x;
-			break;
+	}
+
+	// both channels in one loop, so the noise curve draws its samples in the same order as ever
+	template <int function>
+	void shapeBlock(float* left, float* right, int numSamples) noexcept {
+		int i = 0;
+#if AP_SIMD_WAVESHAPER
+		if constexpr (hasRegisterKernel(function)) {
+			constexpr int width = (int)juce::dsp::SIMDRegister<float>::SIMDNumElements;
+			for (; i + width <= numSamples; i += width) {
+				FastMath<float>::simdStore(shapeRegister<function>(FastMath<float>::simdLoad(left + i)), left + i);
+				FastMath<float>::simdStore(shapeRegister<function>(FastMath<float>::simdLoad(right + i)), right + i);
+			}
+		}
+#endif
+		for (; i < numSamples; i++) {
+			left[i] = shapeSample<function>(left[i]);
+			right[i] = shapeSample<function>(right[i]);
+		}
+	}
+
+	// picks the kernel once per block
+	void shapeBlock(float* left, float* right, int numSamples) noexcept {
+		switch (currentFunction)
+		{
+		case 0: shapeBlock<0>(left, right, numSamples); break;
+		case 1: shapeBlock<1>(left, right, numSamples); break;
+		case 2: shapeBlock<2>(left, right, numSamples); break;
+		case 3: shapeBlock<3>(left, right, numSamples); break;
+		case 4: shapeBlock<4>(left, right, numSamples); break;
+		case 5: shapeBlock<5>(left, right, numSamples); break;
+		case 6: shapeBlock<6>(left, right, numSamples); break;
+		case 7: shapeBlock<7>(left, right, numSamples); break;
+		case 8: shapeBlock<8>(left, right, numSamples); break;
+		case 9: shapeBlock<9>(left, right, numSamples); break;
+		case 10: shapeBlock<10>(left, right, numSamples); break;
+		case 11: shapeBlock<11>(left, right, numSamples); break;
+		case 12: shapeBlock<12>(left, right, numSamples); break;
+		case 13: shapeBlock<13>(left, right, numSamples); break;
+		case 14: shapeBlock<14>(left, right, numSamples); break;
+		case 15: shapeBlock<15>(left, right, numSamples); break;
+		case 16: shapeBlock<16>(left, right, numSamples); break;
+		default: break;
 		}
 	}
 
     void setGain(float pre, float post)
 	{
 		drive = pre;
+		bitcrushSteps = 8.f - 7.f * (drive / 60.f);
+		const float noiseDrive = std::clamp(drive, 0.f, (float)(ShaperTables::noiseDrives - 1));
+		const int noiseIndex = std::min((int)noiseDrive, ShaperTables::noiseDrives - 2);
+		noiseCurve = tables->noise[noiseIndex];
+		noiseDriveFraction = noiseDrive - (float)noiseIndex;
         preGain.setGainDecibels(pre);
         postGain.setGainDecibels(jmin(post - (pre * 0.33f), -6.f)); // compensate for preGain but only partly
 	}
 	
 private:
     juce::AudioBuffer<float> inBuffer;
+	std::array<std::unique_ptr<juce::dsp::Oversampling<float>>, 3> oversamplers; // 2x, 4x, 8x
+	std::atomic<int> oversampleOrder{ 0 };
+	int activeOrder{ 0 }; // the setting process() last ran with
+	juce::dsp::DelayLine<float, juce::dsp::DelayLineInterpolationTypes::None> dryDelay;
 
     using Filter = juce::dsp::IIR::Filter<float>;
 	Filter preBoostL, preBoostR, postCutL, postCutR, highPassPostL, highPassPostR;
@@ -1105,6 +1397,7 @@ private:
 	
 
 	double sampleRate{ 44100.0 };
+	static constexpr float highPassCutoff = 5.f;
     int currentFunction = -1; // to trigger a change on first setFunctionToUse call
     //juce::dsp::WaveShaper<float> waveShaper;
     float dry{ 0.5f }, wet{ 0.5f };
@@ -1112,12 +1405,118 @@ private:
     juce::dsp::Gain<float> postGain;
     float drive{ 1.f };
 	gin::PinkNoise pinkNoise;
+
+	//==============================================================================
+	// tables for the curves that need transcendentals, shared by every shaper and built
+	// on first use, which is when the processor is constructed
+	struct ShaperTables
+	{
+		static constexpr int size = 4096;
+		static constexpr int noiseSize = 256;
+		static constexpr int noiseDrives = 61; // one noise curve for each dB of drive, interpolated between
+
+		ShaperTables()
+		{
+			for (int i = 0; i <= size; i++) {
+				const double x = -1.0 + 2.0 * i / size; // [-1, 1]
+				atan2[i] = (float)(std::atan(2.0 * x) / 1.10714871779409);
+				atan4[i] = (float)(std::atan(4.0 * x) / 1.32581766366803);
+				atan6[i] = (float)(std::atan(6.0 * x) / 1.40564764938027);
+				tanh2[i] = (float)(std::tanh(2.0 * x) / 0.964027580075817);
+				tanh4[i] = (float)(std::tanh(4.0 * x) / 0.999329299739067);
+				tanh6[i] = (float)(std::tanh(6.0 * x) / 0.999987711650796);
+				halfwave[i] = x > 0.0 ? (float)(std::tanh(1.5 * x) * 1.10479139298) : 0.f; // 1.104 term is 1/tanh(1.5)
+				fullwave[i] = (float)(std::tanh(3.0 * 4.0 * i / size) * 0.99505475368); // |x| in [0, 4]; tanh(12) is 1 to 10 places
+			}
+			// |p|^e is steepest near 0, so the noise curves are indexed by u = |p|^(1/4) and hold
+			// u^(4e), with 4e in [1, 4]; that's within 2e-4 of pow everywhere, drive included
+			for (int d = 0; d < noiseDrives; d++)
+				for (int i = 0; i <= noiseSize; i++)
+					noise[d][i] = (float)std::pow((double)i / noiseSize, 4.0 * (1.0 - d / 80.0));
+		}
+
+		// linear interpolation over x in [-1, 1], clamped
+		static float lookup(const float* table, float x) noexcept
+		{
+			const float pos = (std::clamp(x, -1.f, 1.f) + 1.f) * (size * 0.5f);
+			const int i = std::min((int)pos, size - 1);
+			return table[i] + (table[i + 1] - table[i]) * (pos - (float)i);
+		}
+
+		// linear interpolation over x in [0, 1], clamped
+		static float lookupUnipolar(const float* table, int tableSize, float x) noexcept
+		{
+			const float pos = std::min(x, 1.f) * (float)tableSize;
+			const int i = std::min((int)pos, tableSize - 1);
+			return table[i] + (table[i + 1] - table[i]) * (pos - (float)i);
+		}
+
+		// lookup and lookupUnipolar for a register: the positions and the interpolation
+		// are done across the lanes, and only the reads from the table one lane at a time
+		static juce::dsp::SIMDRegister<float> lookup(const float* table, juce::dsp::SIMDRegister<float> x) noexcept
+		{
+			using Reg = juce::dsp::SIMDRegister<float>;
+			const Reg pos = (Reg::min(Reg::max(x, Reg(-1.f)), Reg(1.f)) + Reg(1.f)) * Reg(size * 0.5f);
+			return interpolate(table, size, pos);
+		}
+
+		static juce::dsp::SIMDRegister<float> lookupUnipolar(const float* table, int tableSize, juce::dsp::SIMDRegister<float> x) noexcept
+		{
+			using Reg = juce::dsp::SIMDRegister<float>;
+			return interpolate(table, tableSize, Reg::min(x, Reg(1.f)) * Reg((float)tableSize));
+		}
+
+		static juce::dsp::SIMDRegister<float> interpolate(const float* table, int tableSize, juce::dsp::SIMDRegister<float> pos) noexcept
+		{
+			using Reg = juce::dsp::SIMDRegister<float>;
+			const Reg index = Reg::min(Reg::truncate(pos), Reg((float)(tableSize - 1))); // pos >= 0, so truncating floors it
+			alignas(Reg::SIMDRegisterSize) float indices[Reg::SIMDNumElements];
+			alignas(Reg::SIMDRegisterSize) float below[Reg::SIMDNumElements];
+			alignas(Reg::SIMDRegisterSize) float above[Reg::SIMDNumElements];
+			index.copyToRawArray(indices);
+			for (size_t lane = 0; lane < Reg::SIMDNumElements; lane++) {
+				const int i = (int)indices[lane];
+				below[lane] = table[i];
+				above[lane] = table[i + 1];
+			}
+			const Reg a = Reg::fromRawArray(below);
+			return a + (Reg::fromRawArray(above) - a) * (pos - index);
+		}
+
+		// atan over the whole line, from the minimax polynomial on [-1, 1]
+		static float atanAnywhere(float x) noexcept
+		{
+			const bool outside = std::abs(x) > 1.f;
+			const float a = FastMath<float>::minimaxAtan(outside ? 1.f / x : x);
+			return outside ? std::copysign(juce::MathConstants<float>::halfPi, x) - a : a;
+		}
+
+		float atan2[size + 1], atan4[size + 1], atan6[size + 1];
+		float tanh2[size + 1], tanh4[size + 1], tanh6[size + 1];
+		float halfwave[size + 1], fullwave[size + 1];
+		float noise[noiseDrives][noiseSize + 1];
+	};
+
+	static const ShaperTables& getShaperTables()
+	{
+		static const ShaperTables shaperTables;
+		return shaperTables;
+	}
+
+	const ShaperTables* tables{ &getShaperTables() };
+	const float* noiseCurve{ tables->noise[1] }; // for the initial drive of 1, followed by the next dB's curve
+	float noiseDriveFraction{ 0.f };
+	float bitcrushSteps{ 8.f - 7.f / 60.f };
 };
 
 class RingModulator
 {
 public:
-	RingModulator() = default;
+	RingModulator() {
+		// built up front, so the latency is known before prepare()
+		oversampler = std::make_unique<juce::dsp::Oversampling<float>>(2, oversampleOrder,
+			juce::dsp::Oversampling<float>::filterHalfBandFIREquiripple, true, true); // whole-sample latency, so it can be compensated
+	}
 	~RingModulator() = default;
 
     struct RingModParams
@@ -1136,71 +1535,50 @@ public:
     {
         sampleRate = spec.sampleRate;
         oversampledSampleRate = sampleRate * oversampleRatio;
-        juce::dsp::ProcessSpec oversampledSpec{ oversampledSampleRate, static_cast<juce::uint32>(spec.maximumBlockSize * oversampleRatio), 2 };
         auto samplesPerBlock = spec.maximumBlockSize * oversampleRatio;
-        constexpr auto filterType = juce::dsp::Oversampling<float>::filterHalfBandFIREquiripple;
-        oversampler = std::make_unique<juce::dsp::Oversampling<float>>(spec.numChannels, oversampleOrder, filterType);
+        jassert(spec.numChannels == 2);
         oversampler->initProcessing((size_t)samplesPerBlock);
         mod1LPCutoff.reset(sampleRate * oversampleRatio, 0.02f);
         mod2LPCutoff.reset(sampleRate * oversampleRatio, 0.02f);
-        LP1.prepare(oversampledSpec);
-		LP2.prepare(oversampledSpec);
-		LP3.prepare(oversampledSpec);
-		LP4.prepare(oversampledSpec);
-		LP1.setResonance(0.707f);
-		LP2.setResonance(0.707f);
-		LP3.setResonance(0.707f);
-		LP4.setResonance(0.707f);
-		LP1.setCutoffFrequency(4000.f);
-		LP2.setCutoffFrequency(4000.f);
-		LP3.setCutoffFrequency(4000.f);
-		LP4.setCutoffFrequency(4000.f);
         inverseOversampledSampleRate = 1.f / oversampledSampleRate;
-        highCut1.prepare(oversampledSpec);
-		highCut2.prepare(oversampledSpec);
-		highCut3.prepare(oversampledSpec);
-		highCut4.prepare(oversampledSpec);
-		lowCut1.prepare(oversampledSpec);
-		lowCut2.prepare(oversampledSpec);
-		lowCut3.prepare(oversampledSpec);
-		lowCut4.prepare(oversampledSpec);
-		highCut1.setCutoffFrequency(params.highcut);
-		highCut2.setCutoffFrequency(params.highcut);
-		highCut3.setCutoffFrequency(params.highcut);
-		highCut4.setCutoffFrequency(params.highcut);
-		lowCut1.setCutoffFrequency(params.lowcut);
-		lowCut2.setCutoffFrequency(params.lowcut);
-		lowCut3.setCutoffFrequency(params.lowcut);
-		lowCut4.setCutoffFrequency(params.lowcut);
-		highCut1.setType(juce::dsp::StateVariableTPTFilterType::lowpass);
-		highCut2.setType(juce::dsp::StateVariableTPTFilterType::lowpass);
-		highCut3.setType(juce::dsp::StateVariableTPTFilterType::lowpass);
-		highCut4.setType(juce::dsp::StateVariableTPTFilterType::lowpass);
-		lowCut1.setType(juce::dsp::StateVariableTPTFilterType::highpass);
-		lowCut2.setType(juce::dsp::StateVariableTPTFilterType::highpass);
-		lowCut3.setType(juce::dsp::StateVariableTPTFilterType::highpass);
-		lowCut4.setType(juce::dsp::StateVariableTPTFilterType::highpass);
-        // do something with this, like report it to processor ---> setLatencySamples((int)oversampler->getLatencyInSamples());
+        for (auto* filter : { &mod1Filter, &mod2Filter, &highCut1, &highCut2, &lowCut1, &lowCut2 })
+            filter->prepare(oversampledSampleRate);
+        mod1Filter.setCutoffFrequency(4000.f);
+        mod2Filter.setCutoffFrequency(4000.f);
+        highCut1.setCutoffFrequency(params.highcut);
+        highCut2.setCutoffFrequency(params.highcut);
+        lowCut1.setCutoffFrequency(params.lowcut);
+        lowCut2.setCutoffFrequency(params.lowcut);
+    }
+
+    // in samples at the base rate, from the oversampling filters; reported to the host by the processor
+    int getLatencySamples() const
+    {
+        return oversampler != nullptr ? (int)oversampler->getLatencyInSamples() : 0;
+    }
+
+    // each stage's low cut and high cut ring longest at the lower of the two cutoffs,
+    // and the two stages run in series; the oversampling filters add their latency
+    double getTailLengthSeconds() const {
+        return 2.0 * EffectTail::filterTail(std::min(params.lowcut, params.highcut)) + getLatencySamples() / sampleRate;
     }
 
     void process(juce::dsp::ProcessContextReplacing<float> context) {
+        using Reg = juce::dsp::SIMDRegister<float>;
+        static_assert(Reg::SIMDNumElements == 4, "one lane per modulator voice");
         auto numSamples = context.getOutputBlock().getNumSamples();
         auto oversampledBlock = oversampler->processSamplesUp(context.getOutputBlock());
-        // auto oversampledContext = juce::dsp::ProcessContextReplacing<float>(oversampledBlock);
-        // do processing in oversampledBuffer
 
         // 1. prepare derived parameters
-        juce::dsp::SIMDRegister<float> mod1freqs{ params.mod1freq }, mod2freqs{ params.mod2freq }, spread{ params.spread }, unity{ 1.f }, semitones;
-        semitones[0] = 0.12f;
-        semitones[1] = 0.06f;
-        semitones[2] = -0.0566f;
-        semitones[3] = -0.1071f;
+        alignas(Reg::SIMDRegisterSize) static constexpr float spreadSemitones[4]{ 0.12f, 0.06f, -0.0566f, -0.1071f };
+        Reg mod1freqs{ params.mod1freq }, mod2freqs{ params.mod2freq }, spread{ params.spread }, unity{ 1.f };
+        const Reg semitones = Reg::fromRawArray(spreadSemitones);
         
         mod1freqs = mod1freqs * (unity + spread * semitones);
         mod2freqs = mod2freqs * (unity + spread * semitones);
 
-        mod1PhaseIncs = mod1freqs * dsp::SIMDRegister<float>(2.0f * juce::MathConstants<float>::pi * (float)inverseOversampledSampleRate);
-        mod2PhaseIncs = mod2freqs * dsp::SIMDRegister<float>(2.0f * juce::MathConstants<float>::pi * (float)inverseOversampledSampleRate);
+        mod1PhaseIncs = mod1freqs * Reg(2.0f * juce::MathConstants<float>::pi * (float)inverseOversampledSampleRate);
+        mod2PhaseIncs = mod2freqs * Reg(2.0f * juce::MathConstants<float>::pi * (float)inverseOversampledSampleRate);
 
         mod1LPCutoff.skip((int)numSamples);
         mod2LPCutoff.skip((int)numSamples);
@@ -1208,129 +1586,49 @@ public:
         mod1LPCutoff.setTargetValue(std::clamp(params.mod1freq * 8.f, 20.f, 20000.f)); // a rough 4 octaves above fundamental
 		mod2LPCutoff.setTargetValue(std::clamp(params.mod2freq * 8.f, 20.f, 20000.f));
 
-		LP1.setCutoffFrequency(mod1LPCutoff.getNextValue());
-		LP2.setCutoffFrequency(mod1LPCutoff.getNextValue());
-		LP3.setCutoffFrequency(mod1LPCutoff.getNextValue());
-		LP4.setCutoffFrequency(mod1LPCutoff.getNextValue());
+		mod1Filter.setCutoffFrequency(mod1LPCutoff.getNextValue());
+		mod2Filter.setCutoffFrequency(mod2LPCutoff.getNextValue());
+		highCut1.setCutoffFrequency(params.highcut);
+		highCut2.setCutoffFrequency(params.highcut);
+		lowCut1.setCutoffFrequency(params.lowcut);
+		lowCut2.setCutoffFrequency(params.lowcut);
+
+        const auto shape1 = shapeWeights(params.shape1), shape2 = shapeWeights(params.shape2);
+        const Reg dry1(1.f - params.mix1), wet1(params.mix1), dry2(1.f - params.mix2), wet2(params.mix2);
 
-        // 2. process modulators
-   
+        // 2. process modulators and apply them to audio, all four lanes at once: the lanes
+        // are the two voices on each side, L1, L2, R1 and R2. Each side's voices keep that
+        // side as their dry signal, and modulate the left and right inputs respectively.
         auto* channelDataL = oversampledBlock.getChannelPointer(0);
         auto* channelDataR = oversampledBlock.getChannelPointer(1);
 
         auto oversampledNumSamples = oversampledBlock.getNumSamples();
 
+        // the lanes go in and out through one aligned array: input, then dry, then the result
+        alignas(Reg::SIMDRegisterSize) float lanes[8];
+
         for (int i = 0; i < (int)oversampledNumSamples; i++) {
-            auto sin1 = FastMath<float>::simdSin(mod1Phases);
-			auto sin2 = FastMath<float>::simdSin(mod2Phases);
-			auto square1 = simdSquare(mod1Phases);
-			auto square2 = simdSquare(mod2Phases);
-			auto saw1 = simdSaw(mod1Phases);
-			auto saw2 = simdSaw(mod2Phases);
-            
-
-            juce::dsp::SIMDRegister<float> mod1, mod2;
-			if (params.shape1 < 0.5f) {
-				mod1[0] = sin1[0] * (1.f - params.shape1 * 2.0f) + square1[0] * params.shape1 * 2.0f;
-				mod1[1] = sin1[1] * (1.f - params.shape1 * 2.0f) + square1[1] * params.shape1 * 2.0f;
-				mod1[2] = sin1[2] * (1.f - params.shape1 * 2.0f) + square1[2] * params.shape1 * 2.0f;
-				mod1[3] = sin1[3] * (1.f - params.shape1 * 2.0f) + square1[3] * params.shape1 * 2.0f;
-			}
-			else {
-				mod1[0] = square1[0] * (1.0f - params.shape1) * 2.0f + saw1[0] * (params.shape1 - 0.5f) * 2.f;
-				mod1[1] = square1[1] * (1.0f - params.shape1) * 2.0f + saw1[1] * (params.shape1 - 0.5f) * 2.f;
-				mod1[2] = square1[2] * (1.0f - params.shape1) * 2.0f + saw1[2] * (params.shape1 - 0.5f) * 2.f;
-				mod1[3] = square1[3] * (1.0f - params.shape1) * 2.0f + saw1[3] * (params.shape1 - 0.5f) * 2.f;
-			}
-			mod1[0] = LP1.processSample(0, mod1[0]);
-			mod1[1] = LP1.processSample(1, mod1[1]);
-            mod1[2] = LP2.processSample(0, mod1[2]);
-			mod1[3] = LP2.processSample(0, mod1[3]);
-
-            if (params.shape2 < 0.5f) {
-                mod2[0] = sin2[0] * (1.f - params.shape2 * 2.0f) + square2[0] * params.shape2 * 2.0f;
-                mod2[1] = sin2[1] * (1.f - params.shape2 * 2.0f) + square2[1] * params.shape2 * 2.0f;
-                mod2[2] = sin2[2] * (1.f - params.shape2 * 2.0f) + square2[2] * params.shape2 * 2.0f;
-                mod2[3] = sin2[3] * (1.f - params.shape2 * 2.0f) + square2[3] * params.shape2 * 2.0f;
-            }
-			else {
-				mod2[0] = square2[0] * (1.0f - params.shape2) * 2.0f + saw2[0] * (params.shape2 - 0.5f) * 2.f;
-				mod2[1] = square2[1] * (1.0f - params.shape2) * 2.0f + saw2[1] * (params.shape2 - 0.5f) * 2.f;
-				mod2[2] = square2[2] * (1.0f - params.shape2) * 2.0f + saw2[2] * (params.shape2 - 0.5f) * 2.f;
-				mod2[3] = square2[3] * (1.0f - params.shape2) * 2.0f + saw2[3] * (params.shape2 - 0.5f) * 2.f;
-			}
-			mod2[0] = LP3.processSample(0, mod2[0]);
-			mod2[1] = LP3.processSample(1, mod2[1]);
-			mod2[2] = LP4.processSample(0, mod2[2]);
-			mod2[3] = LP4.processSample(0, mod2[2]);
-
-            // 3. apply modulators to audio
-
-            auto sampleL = channelDataL[i];
-            auto sampleR = channelDataR[i];
-            
-            // 4. apply filters to multipliers' outputs
-            auto modSampleL1Stage1 = sampleL * mod1[0] * params.mix1;
-			auto modSampleL2Stage1 = sampleR * mod1[1] * params.mix1;
-			auto modSampleR1Stage1 = sampleL * mod1[2] * params.mix1;
-			auto modSampleR2Stage1 = sampleR * mod1[3] * params.mix1;
-            modSampleL1Stage1 = highCut1.processSample(0, modSampleL1Stage1);
-			modSampleL2Stage1 = highCut1.processSample(1, modSampleL2Stage1);
-            modSampleR1Stage1 = highCut2.processSample(0, modSampleR1Stage1);
-			modSampleR2Stage1 = highCut2.processSample(1, modSampleR2Stage1);
-			modSampleL1Stage1 = lowCut1.processSample(0, modSampleL1Stage1);
-			modSampleL2Stage1 = lowCut1.processSample(1, modSampleL2Stage1);
-			modSampleR1Stage1 = lowCut2.processSample(0, modSampleR1Stage1);
-			modSampleR2Stage1 = lowCut2.processSample(1, modSampleR2Stage1);
-
-            auto sampleL1Stage1 = (sampleL * (1.f - params.mix1) + modSampleL1Stage1);
-            auto sampleL2Stage1 = (sampleL * (1.f - params.mix1) + modSampleL2Stage1);
-            auto sampleR1Stage1 = (sampleR * (1.f - params.mix1) + modSampleR1Stage1);
-            auto sampleR2Stage1 = (sampleR * (1.f - params.mix1) + modSampleR2Stage1);
-
-			auto modSampleL1Stage2 = sampleL1Stage1 * mod2[0] * params.mix2;
-			auto modSampleL2Stage2 = sampleL2Stage1 * mod2[1] * params.mix2;
-			auto modSampleR1Stage2 = sampleR1Stage1 * mod2[2] * params.mix2;
-			auto modSampleR2Stage2 = sampleR2Stage1 * mod2[3] * params.mix2;
-			modSampleL1Stage2 = highCut3.processSample(0, modSampleL1Stage2);
-			modSampleL2Stage2 = highCut3.processSample(1, modSampleL2Stage2);
-			modSampleR1Stage2 = highCut4.processSample(0, modSampleR1Stage2);
-			modSampleR2Stage2 = highCut4.processSample(1, modSampleR2Stage2);
-			modSampleL1Stage2 = lowCut3.processSample(0, modSampleL1Stage2);
-			modSampleL2Stage2 = lowCut3.processSample(1, modSampleL2Stage2);
-			modSampleR1Stage2 = lowCut4.processSample(0, modSampleR1Stage2);
-			modSampleR2Stage2 = lowCut4.processSample(1, modSampleR2Stage2);
-
-            auto sampleL1Stage2 = (sampleL1Stage1 * (1.f - params.mix2) + modSampleL1Stage2);
-            auto sampleL2Stage2 = (sampleL2Stage1 * (1.f - params.mix2) + modSampleL2Stage2);
-            auto sampleR1Stage2 = (sampleR1Stage1 * (1.f - params.mix2) + modSampleR1Stage2);
-            auto sampleR2Stage2 = (sampleR2Stage1 * (1.f - params.mix2) + modSampleR2Stage2);
-            
-            auto sampleLSum = (sampleL1Stage2 + sampleL2Stage2) * 0.5f;
-            auto sampleRSum = (sampleR1Stage2 + sampleR2Stage2) * 0.5f;
-
-            channelDataL[i] = sampleLSum; // sampleLSum;
-            channelDataR[i] = sampleRSum; // sampleRSum;
-
-            mod1Phases += mod1PhaseIncs;
-            mod2Phases += mod2PhaseIncs;
-
-            for (int k = 0; k < 4; k++) {
-				if (mod1Phases[k] > juce::MathConstants<float>::pi)
-					mod1Phases[k] = mod1Phases[k] - 2.f * juce::MathConstants<float>::pi;
-				if (mod2Phases[k] > juce::MathConstants<float>::pi)
-					mod2Phases[k] = mod2Phases[k] - 2.f * juce::MathConstants<float>::pi;
-			}
+            const Reg mod1 = mod1Filter.lowpass(FastMath<float>::simdSin(mod1Phases) * shape1[0]
+                + simdSquare(mod1Phases) * shape1[1] + simdSaw(mod1Phases) * shape1[2]);
+            const Reg mod2 = mod2Filter.lowpass(FastMath<float>::simdSin(mod2Phases) * shape2[0]
+                + simdSquare(mod2Phases) * shape2[1] + simdSaw(mod2Phases) * shape2[2]);
+
+            const float sampleL = channelDataL[i], sampleR = channelDataR[i];
+            lanes[0] = sampleL; lanes[1] = sampleR; lanes[2] = sampleL; lanes[3] = sampleR;
+            lanes[4] = sampleL; lanes[5] = sampleL; lanes[6] = sampleR; lanes[7] = sampleR;
+            const Reg input = Reg::fromRawArray(lanes), dry = Reg::fromRawArray(lanes + 4);
+
+            // 3. filter the multipliers' outputs and mix each stage with its input
+            const Reg stage1 = dry * dry1 + lowCut1.highpass(highCut1.lowpass(input * mod1 * wet1));
+            const Reg stage2 = stage1 * dry2 + lowCut2.highpass(highCut2.lowpass(stage1 * mod2 * wet2));
+
+            stage2.copyToRawArray(lanes);
+            channelDataL[i] = (lanes[0] + lanes[1]) * 0.5f;
+            channelDataR[i] = (lanes[2] + lanes[3]) * 0.5f;
+
+            mod1Phases = simdWrap(mod1Phases + mod1PhaseIncs);
+            mod2Phases = simdWrap(mod2Phases + mod2PhaseIncs);
         }
-
-        highCut1.setCutoffFrequency(params.highcut);
-        highCut2.setCutoffFrequency(params.highcut);
-		highCut3.setCutoffFrequency(params.highcut);
-		highCut4.setCutoffFrequency(params.highcut);
-		lowCut1.setCutoffFrequency(params.lowcut);
-		lowCut2.setCutoffFrequency(params.lowcut);
-		lowCut3.setCutoffFrequency(params.lowcut);
-		lowCut4.setCutoffFrequency(params.lowcut);
         
         // processed that buffer: downsample it, and SHIP IT OUT!
         oversampler->processSamplesDown(context.getOutputBlock());
@@ -1358,22 +1656,79 @@ private:
 	}
 
     juce::dsp::SIMDRegister<float> simdSquare(juce::dsp::SIMDRegister<float> phases) {
-		juce::dsp::SIMDRegister<float> square;
-        square[0] = phases[0] > 0.f ? 1.f : -1.f;
-		square[1] = phases[1] > 0.f ? 1.f : -1.f;
-		square[2] = phases[2] > 0.f ? 1.f : -1.f;
-		square[3] = phases[3] > 0.f ? 1.f : -1.f;
-        return square;
+        using Reg = juce::dsp::SIMDRegister<float>;
+        return (Reg(2.f) & Reg::greaterThan(phases, Reg(0.f))) - Reg(1.f);
     }
-    
+
+    // phases advance by less than a turn per sample, so one subtraction wraps them
+    juce::dsp::SIMDRegister<float> simdWrap(juce::dsp::SIMDRegister<float> phases) {
+        using Reg = juce::dsp::SIMDRegister<float>;
+        const Reg pi(juce::MathConstants<float>::pi);
+        return phases - (Reg(2.f * juce::MathConstants<float>::pi) & Reg::greaterThan(phases, pi));
+    }
+
+    // sine, square and saw amounts: sine -> square over [0, 0.5], then square -> saw
+    static std::array<float, 3> shapeWeights(float shape) {
+        if (shape < 0.5f)
+            return { 1.f - shape * 2.0f, shape * 2.0f, 0.f };
+        return { 0.f, (1.0f - shape) * 2.0f, (shape - 0.5f) * 2.f };
+    }
+
+public:
+    // four of juce::dsp::StateVariableTPTFilter side by side, one per lane, all with
+    // the same cutoff and resonance
+    struct QuadSVF
+    {
+        using Reg = juce::dsp::SIMDRegister<float>;
+
+        void prepare(double newSampleRate) {
+            sampleRate = newSampleRate;
+            update();
+            s1 = Reg(0.f);
+            s2 = Reg(0.f);
+        }
+
+        void setCutoffFrequency(float newCutoff) {
+            if (newCutoff != cutoff) {
+                cutoff = newCutoff;
+                update();
+            }
+        }
+
+        Reg lowpass(Reg x) { Reg yLP, yHP; process(x, yLP, yHP); return yLP; }
+        Reg highpass(Reg x) { Reg yLP, yHP; process(x, yLP, yHP); return yHP; }
+
+    private:
+        void process(Reg x, Reg& yLP, Reg& yHP) {
+            yHP = (x - s1 * gPlusR2 - s2) * h;
+            const Reg yBP = yHP * g + s1;
+            s1 = yHP * g + yBP;
+            yLP = yBP * g + s2;
+            s2 = yBP * g + yLP;
+        }
+
+        void update() {
+            const float gain = (float)std::tan(juce::MathConstants<double>::pi * cutoff / sampleRate);
+            g = Reg(gain);
+            gPlusR2 = Reg(gain + R2);
+            h = Reg(1.f / (1.f + R2 * gain + gain * gain));
+        }
+
+        static constexpr float R2 = 1.41421356f; // 1 / resonance, for a resonance of 1/sqrt(2)
+        double sampleRate{ 44100.0 };
+        float cutoff{ 1000.f };
+        Reg g{ 0.f }, gPlusR2{ 0.f }, h{ 0.f }, s1{ 0.f }, s2{ 0.f };
+    };
+
+private:
     // internal storage / utility
     std::unique_ptr<juce::dsp::Oversampling<float>> oversampler;
     int oversampleOrder{ 1 }, oversampleRatio{ 2 };
     double oversampledSampleRate{ sampleRate * oversampleRatio };
     double inverseOversampledSampleRate{ 1.0 / oversampledSampleRate };
     RingModParams params;
-    juce::dsp::StateVariableTPTFilter<float> LP1, LP2, LP3, LP4; // these are stereo
-    juce::dsp::StateVariableTPTFilter<float> highCut1, highCut2, highCut3, highCut4, lowCut1, lowCut2, lowCut3, lowCut4; // post multiply, pre-stagemix
+    QuadSVF mod1Filter, mod2Filter; // smooth each modulator's four voices
+    QuadSVF highCut1, highCut2, lowCut1, lowCut2; // post multiply, pre-stagemix, for stages 1 and 2
     juce::dsp::SIMDRegister<float> mod1Phases{ 0.0f }, mod2Phases{ 0.0f };
     juce::dsp::SIMDRegister<float> mod1PhaseIncs{ 0.0f }, mod2PhaseIncs{ 0.0f };
 
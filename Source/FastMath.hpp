@@ -43,6 +43,7 @@ SOFTWARE.
 
 #define _USE_MATH_DEFINES
 #include <cmath>
+#include <cstring>
 
 //------------------------------------------------------------------------------
 // FastMath contains some fast approximations for trigonometric functions.
@@ -106,6 +107,18 @@ template <class F> class FastMath {
         - 2.3868346521031027639830001794722295e-8f * x2)))));
     }
 
+    // minimaxSin for arguments already in [-pi, pi], e.g. from fastAtan2: no wrap, no branches
+    static inline float minimaxSinInRange(float x1) {
+        float x2 = x1 * x1;
+
+        return x1 * (0.99999999997884898600402426033768998f
+        + x2 * (-0.166666666088260696413164261885310067f
+        + x2 * (0.00833333072055773645376566203656709979f
+        + x2 * (-0.000198408328232619552901560108010257242f
+        + x2 * (2.75239710746326498401791551303359689e-6f
+        - 2.3868346521031027639830001794722295e-8f * x2)))));
+    }
+
     static inline juce::dsp::SIMDRegister<float> simdSin(juce::dsp::SIMDRegister<float> x1) {
 		juce::dsp::SIMDRegister<float> x2 = x1 * x1;
 
@@ -117,6 +130,36 @@ template <class F> class FastMath {
 		- juce::dsp::SIMDRegister<float>(2.3868346521031027639830001794722295e-8f) * x2)))));
 	}
 
+	// branch-free normalizePhase for four phases at once: x - 2pi * round(x / 2pi)
+	static inline juce::dsp::SIMDRegister<float> simdNormalizePhase(juce::dsp::SIMDRegister<float> x1) {
+		using Reg = juce::dsp::SIMDRegister<float>;
+		const Reg zero(0.0f);
+		Reg half = (Reg(0.5f) & Reg::greaterThanOrEqual(x1, zero)) | (Reg(-0.5f) & Reg::lessThan(x1, zero));
+		Reg turns = Reg::truncate(x1 * Reg(0.5f / juce::MathConstants<float>::pi) + half);
+		return x1 - turns * Reg(2.0f * juce::MathConstants<float>::pi);
+	}
+
+	static inline juce::dsp::SIMDRegister<float> simdMinimaxSin(juce::dsp::SIMDRegister<float> x1) {
+		return simdSin(simdNormalizePhase(x1));
+	}
+
+	// SIMDRegister::fromRawArray and copyToRawArray want aligned memory, which a buffer
+	// sliced at an arbitrary sample isn't; these go through an aligned copy, which the
+	// compiler turns into an unaligned load or store
+	static inline juce::dsp::SIMDRegister<float> simdLoad(const float* source) {
+		using Reg = juce::dsp::SIMDRegister<float>;
+		alignas(Reg::SIMDRegisterSize) float values[Reg::SIMDNumElements];
+		std::memcpy(values, source, sizeof(values));
+		return Reg::fromRawArray(values);
+	}
+
+	static inline void simdStore(juce::dsp::SIMDRegister<float> reg, float* dest) {
+		using Reg = juce::dsp::SIMDRegister<float>;
+		alignas(Reg::SIMDRegisterSize) float values[Reg::SIMDNumElements];
+		reg.copyToRawArray(values);
+		std::memcpy(dest, values, sizeof(values));
+	}
+
 	static inline float minimaxAtan(float a) {
 		float b = a * a;
 		float u = -0.011719135406045413f;
@@ -182,6 +225,30 @@ template <class F> class FastMath {
 	}
     
     
+	// fastAtan2 with every branch turned into a select, so a loop of them vectorizes;
+	// gives the same results as fastAtan2
+	static inline float fastAtan2Branchless(float x, float y) {
+		const bool swap = !(fabsf(x) > fabsf(y)); // atan(y/x) = PI/2 - atan(x/y) if |y/x| > 1
+		const float num = swap ? x : y;
+		const float den = swap ? y : x;
+		const float atan = minimaxAtan(num / (den != 0.0f ? den : 1.0f));
+		const float halfPi = juce::MathConstants<float>::pi * 0.5f;
+		const float direct = atan + ((x > 0.0f) ? 0.0f : ((y >= 0.0f) ? juce::MathConstants<float>::pi : -juce::MathConstants<float>::pi));
+		const float swapped = -atan + ((y > 0.0f) ? halfPi : -halfPi);
+		return (x == 0.0f && y == 0.0f) ? 0.0f : (swap ? swapped : direct);
+	}
+
+	// fused angle and magnitude of the vectors (y[i] - yOffset, x[i]), as used for
+	// the bodies of the orbital engine: angles[i] = fastAtan2(y[i] - yOffset, x[i])
+	static inline void angleAndMagnitude(const float* x, const float* y, float yOffset,
+		float* angles, float* magnitudes, int numSamples) {
+		for (int i = 0; i < numSamples; i++) {
+			const float dy = y[i] - yOffset;
+			angles[i] = fastAtan2Branchless(dy, x[i]);
+			magnitudes[i] = std::sqrt(x[i] * x[i] + dy * dy);
+		}
+	}
+
 inline static float sineValueForPhaseAndTones(float phase, float tones) {
         float fullTones{ 0.f }, value{ 0.0f };
         float partialToneFraction = std::modf(tones, &fullTones);
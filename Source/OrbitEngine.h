@@ -0,0 +1,256 @@
+/*
+ * Audible Planets - an expressive, quasi-Ptolemaic semi-modular synthesizer
+ *
+ * Copyright 2024, Greg Recco
+ *
+ * Audible Planets is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * All source for Audible Planets is available at
+ * https://github.com/gregrecco67/AudiblePlanets
+ */
+
+#pragma once
+
+#include "QuadOsc.h"
+
+// Block-wise stages of the epicycle pipeline. Each stage runs over a whole block
+// of structure-of-arrays data with no branches in the inner loop, so the compiler
+// can pack consecutive samples into SIMD lanes.
+
+// a block-rate parameter as seen by the sample loops: constant, or ramped linearly
+// from the previous block's value so that it reaches the new one on the last sample
+struct BlockRamp {
+	float start{ 0.f }, step{ 0.f };
+
+	void set(float previous, float current, int numSamples, bool ramp) {
+		start = ramp ? previous : current;
+		step = (ramp && numSamples > 0) ? (current - previous) / (float)numSamples : 0.f;
+	}
+
+	float operator[](int i) const { return start + step * (float)(i + 1); }
+};
+
+// squash matrices for a block; b and c are always equal, so only b is stored
+struct StereoSquashBlock {
+	static constexpr int maxSamples = StereoPositionBlock::maxSamples;
+	float aL[maxSamples]{}, bL[maxSamples]{}, dL[maxSamples]{};
+	float aR[maxSamples]{}, bR[maxSamples]{}, dR[maxSamples]{};
+};
+
+// what a body contributes to the output: its angle-only ("mod") and
+// angle-and-magnitude ("demod") samples
+struct StereoBodyBlock {
+	static constexpr int maxSamples = StereoPositionBlock::maxSamples;
+	float modL[maxSamples]{}, modR[maxSamples]{}, demodL[maxSamples]{}, demodR[maxSamples]{};
+};
+
+struct OrbitEngine
+{
+	static constexpr int maxBlockSize = StereoPositionBlock::maxSamples;
+
+	// squash matrix for each orbit that can be the basis for another:
+	// more squash = smaller k, which scales about the tangent to the deferent
+	static void computeSquash(const StereoPositionBlock& p, float equant, const BlockRamp& squashK, StereoSquashBlock& s, int numSamples)
+	{
+		for (int i = 0; i < numSamples; i++) {
+			const float k = squashK[i];
+			// get distances in order to normalize vectors
+			float distanceL = std::sqrt(p.xL[i] * p.xL[i] + (p.yL[i] - equant) * (p.yL[i] - equant));
+			float distanceR = std::sqrt(p.xR[i] * p.xR[i] + (p.yR[i] - equant) * (p.yR[i] - equant));
+			// what we want is the tangent to the orbit at this point, so swap x and y and negate y
+			float cosThetaL = (p.yL[i] - equant) / (distanceL + .000001f);
+			float sinThetaL = -p.xL[i] / (distanceL + .000001f);
+			float cosThetaR = (p.yR[i] - equant) / (distanceR + .000001f);
+			float sinThetaR = -p.xR[i] / (distanceR + .000001f);
+			float cos2ThetaL = cosThetaL * cosThetaL;
+			float cos2ThetaR = cosThetaR * cosThetaR;
+			float sin2ThetaL = sinThetaL * sinThetaL;
+			float sin2ThetaR = sinThetaR * sinThetaR;
+
+			s.aL[i] = cos2ThetaL + k * sin2ThetaL;
+			s.bL[i] = cosThetaL * sinThetaL * (1.0f - k);
+			s.dL[i] = sin2ThetaL + k * cos2ThetaL;
+			s.aR[i] = cos2ThetaR + k * sin2ThetaR;
+			s.bR[i] = cosThetaR * sinThetaR * (1.0f - k);
+			s.dR[i] = sin2ThetaR + k * cos2ThetaR;
+		}
+	}
+
+	// position of body on first circle, scaled by its envelope and volume
+	static void placeBody(const StereoPositionBlock& osc, const float* env, float vol,
+		StereoPositionBlock& out, int numSamples)
+	{
+		for (int i = 0; i < numSamples; i++) {
+			float gain = env[i] * vol;
+			out.xL[i] = osc.xL[i] * gain;
+			out.yL[i] = osc.yL[i] * gain;
+			out.xR[i] = osc.xR[i] * gain;
+			out.yR[i] = osc.yR[i] * gain;
+		}
+	}
+
+	// out = base + (osc * squash) * (env * vol), i.e. a body riding on another,
+	// its orbit squashed along the tangent of the one it's orbiting
+	static void addEpicycle(const StereoPositionBlock& base, const StereoPositionBlock& osc,
+		const StereoSquashBlock& s, const float* env, float vol, StereoPositionBlock& out, int numSamples)
+	{
+		for (int i = 0; i < numSamples; i++) {
+			float gain = env[i] * vol;
+			out.xL[i] = base.xL[i] + (s.aL[i] * osc.xL[i] + s.bL[i] * osc.yL[i]) * gain;
+			out.yL[i] = base.yL[i] + (s.bL[i] * osc.xL[i] + s.dL[i] * osc.yL[i]) * gain;
+			out.xR[i] = base.xR[i] + (s.aR[i] * osc.xR[i] + s.bR[i] * osc.yR[i]) * gain;
+			out.yR[i] = base.yR[i] + (s.bR[i] * osc.xR[i] + s.dR[i] * osc.yR[i]) * gain;
+		}
+	}
+
+	// interpret a body's position: angle about the equant gives the waveform,
+	// blended sine <-> square (blend < 0.5) or square <-> saw; the demod sample
+	// also takes the magnitude
+	template <bool sineToSquare>
+	static void renderBody(const StereoPositionBlock& epi, const float* env, float equant, float blend,
+		const BlockRamp& demodVol, StereoBodyBlock& out, int numSamples)
+	{
+		const float firstAmt = sineToSquare ? 1.f - blend * 2.0f : (1.0f - blend) * 2.0f;
+		const float secondAmt = sineToSquare ? blend * 2.0f : (blend - 0.5f) * 2.f;
+
+		float angleL[maxBlockSize], angleR[maxBlockSize], distanceL[maxBlockSize], distanceR[maxBlockSize];
+		FastMath<float>::angleAndMagnitude(epi.xL, epi.yL, equant, angleL, distanceL, numSamples);
+		FastMath<float>::angleAndMagnitude(epi.xR, epi.yR, equant, angleR, distanceR, numSamples);
+
+		for (int i = 0; i < numSamples; i++) {
+			float sampleL, sampleR;
+			if constexpr (sineToSquare) {
+				sampleL = FastMath<float>::minimaxSinInRange(angleL[i]) * firstAmt + ((angleL[i] > 0.f) ? 1.0f : -1.0f) * secondAmt;
+				sampleR = FastMath<float>::minimaxSinInRange(angleR[i]) * firstAmt + ((angleR[i] > 0.f) ? 1.0f : -1.0f) * secondAmt;
+			}
+			else {
+				sampleL = ((angleL[i] > 0.f) ? 1.0f : -1.0f) * firstAmt + ((angleL[i] * (float)inv_pi) * 2.0f - 1.0f) * secondAmt;
+				sampleR = ((angleR[i] > 0.f) ? 1.0f : -1.0f) * firstAmt + ((angleR[i] * (float)inv_pi) * 2.0f - 1.0f) * secondAmt;
+			}
+
+			// since mod samples are angle-only, we need to reapply their envelope values
+			out.modL[i] = sampleL * env[i];
+			out.modR[i] = sampleR * env[i];
+			out.demodL[i] = sampleL * (distanceL[i] * demodVol[i]); // adjustable balancing term
+			out.demodR[i] = sampleR * (distanceR[i] * demodVol[i]);
+		}
+	}
+
+	// what render() reads for one block: each oscillator's positions, the envelope
+	// assigned to it and its volume, and the timbre parameters
+	struct Inputs {
+		const StereoPositionBlock* osc[4]{};
+		const float* env[4]{};
+		float vol[4]{};
+		float equant{ 0.f }, blend{ 0.f };
+		BlockRamp squashK, demodVol, demodmix;
+	};
+
+	// working storage for render(), kept with the voice rather than on the stack
+	struct Workspace {
+		StereoPositionBlock epi1, epi2, epi3, epi4;
+		StereoSquashBlock squash1, squash2, squash3;
+		StereoBodyBlock body2, body3, body4;
+	};
+
+	// the whole enchilada for one voice, one stage at a time over the block:
+	// one kernel per algorithm and blend range
+	template <int algorithm, bool sineToSquare>
+	static void render(const Inputs& in, Workspace& w, float* outL, float* outR, int numSamples)
+	{
+		const StereoPositionBlock& osc1 = *in.osc[0], & osc2 = *in.osc[1], & osc3 = *in.osc[2], & osc4 = *in.osc[3];
+
+		// 1. squash matrices, only for the orbits that are the basis for another in this algorithm
+		computeSquash(osc1, in.equant, in.squashK, w.squash1, numSamples);
+		if constexpr (algorithm == 0 || algorithm == 1)
+			computeSquash(osc2, in.equant, in.squashK, w.squash2, numSamples);
+		if constexpr (algorithm == 0 || algorithm == 2)
+			computeSquash(osc3, in.equant, in.squashK, w.squash3, numSamples);
+
+		// 2. bodies' positions
+		placeBody(osc1, in.env[0], in.vol[0], w.epi1, numSamples);
+		addEpicycle(w.epi1, osc2, w.squash1, in.env[1], in.vol[1], w.epi2, numSamples);
+		if constexpr (algorithm == 0) { // 1-2-3-(4)
+			addEpicycle(w.epi2, osc3, w.squash2, in.env[2], in.vol[2], w.epi3, numSamples);
+			addEpicycle(w.epi3, osc4, w.squash3, in.env[3], in.vol[3], w.epi4, numSamples);
+		}
+		if constexpr (algorithm == 1) { // 1-2-(3), 2-(4)
+			addEpicycle(w.epi2, osc3, w.squash2, in.env[2], in.vol[2], w.epi3, numSamples);
+			addEpicycle(w.epi2, osc4, w.squash2, in.env[3], in.vol[3], w.epi4, numSamples);
+		}
+		if constexpr (algorithm == 2) { // 1-(2), 1-3-(4)
+			addEpicycle(w.epi1, osc3, w.squash1, in.env[2], in.vol[2], w.epi3, numSamples);
+			addEpicycle(w.epi3, osc4, w.squash3, in.env[3], in.vol[3], w.epi4, numSamples);
+		}
+		if constexpr (algorithm == 3) { // 1-(2), 1-(3), 1-(4)
+			addEpicycle(w.epi1, osc3, w.squash1, in.env[2], in.vol[2], w.epi3, numSamples);
+			addEpicycle(w.epi1, osc4, w.squash1, in.env[3], in.vol[3], w.epi4, numSamples);
+		}
+
+		// 3. interpret the audible bodies' positions: angle gives the waveform,
+		// magnitude demodulates it
+		renderBody<sineToSquare>(w.epi4, in.env[3], in.equant, in.blend, in.demodVol, w.body4, numSamples);
+		if constexpr (algorithm == 1 || algorithm == 3)
+			renderBody<sineToSquare>(w.epi3, in.env[2], in.equant, in.blend, in.demodVol, w.body3, numSamples);
+		if constexpr (algorithm == 2 || algorithm == 3)
+			renderBody<sineToSquare>(w.epi2, in.env[1], in.equant, in.blend, in.demodVol, w.body2, numSamples);
+
+		// 4. mix by demodmix AND ALGO, and ship it out
+		const StereoBodyBlock& body2 = w.body2, & body3 = w.body3, & body4 = w.body4;
+		if constexpr (algorithm == 0) {
+			for (int i = 0; i < numSamples; i++) {
+				const float demodmix = in.demodmix[i];
+				outL[i] = (body4.modL[i] * (1.0f - demodmix) + body4.demodL[i] * demodmix);
+				outR[i] = (body4.modR[i] * (1.0f - demodmix) + body4.demodR[i] * demodmix);
+			}
+		}
+		if constexpr (algorithm == 1) {
+			for (int i = 0; i < numSamples; i++) {
+				const float demodmix = in.demodmix[i];
+				outL[i] = ((body3.modL[i] + body4.modL[i]) * 0.5f * (1.0f - demodmix) + (body3.demodL[i] + body4.demodL[i]) * 0.5f * demodmix);
+				outR[i] = ((body3.modR[i] + body4.modR[i]) * 0.5f * (1.0f - demodmix) + (body3.demodR[i] + body4.demodR[i]) * 0.5f * demodmix);
+			}
+		}
+		if constexpr (algorithm == 2) {
+			for (int i = 0; i < numSamples; i++) {
+				const float demodmix = in.demodmix[i];
+				outL[i] = ((body2.modL[i] + body4.modL[i]) * 0.5f * (1.0f - demodmix) + (body2.demodL[i] + body4.demodL[i]) * 0.5f * demodmix);
+				outR[i] = ((body2.modR[i] + body4.modR[i]) * 0.5f * (1.0f - demodmix) + (body2.demodR[i] + body4.demodR[i]) * 0.5f * demodmix);
+			}
+		}
+		if constexpr (algorithm == 3) {
+			// the right channel has always taken body 3's demod from the left; kept so patches sound the same
+			for (int i = 0; i < numSamples; i++) {
+				const float demodmix = in.demodmix[i];
+				outL[i] = ((body2.modL[i] + body3.modL[i] + body4.modL[i]) * 0.333f * (1.0f - demodmix) + (body2.demodL[i] + body3.demodL[i] + body4.demodL[i]) * 0.333f * demodmix);
+				outR[i] = ((body2.modR[i] + body3.modR[i] + body4.modR[i]) * 0.333f * (1.0f - demodmix) + (body2.demodR[i] + body3.demodL[i] + body4.demodR[i]) * 0.333f * demodmix);
+			}
+		}
+	}
+
+	// picks the kernel for this block's algorithm and blend range; returns false,
+	// leaving the output alone, if there's no such algorithm
+	static bool render(int algorithm, const Inputs& in, Workspace& w, float* outL, float* outR, int numSamples)
+	{
+		const bool sineToSquare = in.blend < 0.5f;
+		switch (algorithm) {
+		case 0:
+			sineToSquare ? render<0, true>(in, w, outL, outR, numSamples) : render<0, false>(in, w, outL, outR, numSamples);
+			return true;
+		case 1:
+			sineToSquare ? render<1, true>(in, w, outL, outR, numSamples) : render<1, false>(in, w, outL, outR, numSamples);
+			return true;
+		case 2:
+			sineToSquare ? render<2, true>(in, w, outL, outR, numSamples) : render<2, false>(in, w, outL, outR, numSamples);
+			return true;
+		case 3:
+			sineToSquare ? render<3, true>(in, w, outL, outR, numSamples) : render<3, false>(in, w, outL, outR, numSamples);
+			return true;
+		default:
+			return false;
+		}
+	}
+};
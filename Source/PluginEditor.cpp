@@ -92,7 +92,7 @@ void APAudioProcessorEditor::timerCallback()
 {
 	if (MTS_HasMaster(proc.client))
 	{
-		scaleName.setText(proc.scaleName, juce::dontSendNotification);
+		scaleName.setText(MTS_GetScaleName(proc.client), juce::dontSendNotification);
 		scaleName.setColour(juce::Label::backgroundColourId, juce::Colour(0xff16171A).brighter(0.3f));
 	}
 	else
@@ -100,8 +100,9 @@ void APAudioProcessorEditor::timerCallback()
 		scaleName.setText("", juce::dontSendNotification);
 		scaleName.setColour(juce::Label::backgroundColourId, juce::Colours::transparentBlack);
 	}
-	learningLabel.setColour(juce::Label::backgroundColourId, (!proc.learningLabel.isEmpty()) ? juce::Colour(0xff16171A).brighter(0.3f) : juce::Colours::transparentBlack);
-	learningLabel.setText(proc.learningLabel, juce::dontSendNotification);
+	const bool learning = proc.modMatrix.getLearn().id != -1;
+	learningLabel.setColour(juce::Label::backgroundColourId, learning ? juce::Colour(0xff16171A).brighter(0.3f) : juce::Colours::transparentBlack);
+	learningLabel.setText(learning ? "Learning: " + proc.modMatrix.getModSrcName(proc.modMatrix.getLearn()) : juce::String(), juce::dontSendNotification);
 }
 
 APAudioProcessorEditor::~APAudioProcessorEditor()
@@ -42,6 +42,25 @@ static juce::String waveshaperTypeTextFunction(const gin::Parameter&, float v)
     }
 }
 
+static juce::String voiceMultTextFunction(const gin::Parameter&, float v)
+{
+    return "x" + juce::String(1 << int(v));
+}
+
+static juce::String oversampleTextFunction(const gin::Parameter&, float v)
+{
+    switch (int(v))
+    {
+        case 0: return "Off";
+        case 1: return "2x";
+        case 2: return "4x";
+        case 3: return "8x";
+        default:
+            jassertfalse;
+            return {};
+    }
+}
+
 static juce::String lfoTextFunction(const gin::Parameter&, float v)
 {
     switch ((gin::LFO::WaveShape)int(v))
@@ -477,6 +496,9 @@ void APAudioProcessor::GlobalParams::setup(APAudioProcessor& p)
     mpe            = p.addIntParam("mpe",     "MPE",        "",      "",   { 0.0, 1.0, 1.0, 1.0 }, 0.0f, 0.0f, enableTextFunction);
     pitchbendRange = p.addIntParam("pbrange", "PB Range", "", "", {0.0, 96.0, 1.0, 1.0}, 2.0, 0.0f);
     sidechainEnable = p.addIntParam("sidechain", "Sidechain", "", "", { 0.0, 1.0, 1.0, 1.0 }, 0.0f, 0.0f, enableTextFunction);
+    // voices keeps its original 2-8 range, so saved sessions and host automation still
+    // mean the same thing; this multiplies it, up to AP_MAX_VOICES
+    voiceMult      = p.addIntParam("voicemult", "Voice Mult", "Mult", "", { 0.0, 3.0, 1.0, 1.0 }, 0.0f, 0.0f, voiceMultTextFunction);
 
     level->conversionFunction     = [](float in) { return juce::Decibels::decibelsToGain (in); };
     velSens->conversionFunction   = [](float in) { return in / 100.0f; };
@@ -503,6 +525,7 @@ void APAudioProcessor::WaveshaperParams::setup(APAudioProcessor& p)
     highshelf = p.addExtParam(pfx + "highshelf", name + "High Shelf", "High Shelf", " Hz", { 3000.0f, 12000.0f, 0.0, 1.3f }, 6500.0f, 0.0f);
     hsq = p.addExtParam(pfx + "hsq", name + "HShelf Q", "High Shelf Q", "", { 0.5f, 5.0f, 0.0, 1.0 }, 1.0f, 0.0f);
     lp = p.addExtParam(pfx + "lp", name + "Low Pass", "Low Pass", "", { 20.0f, 20000.0f, 0.0, 0.3f }, 20000.0f, 0.0f);
+    oversample = p.addIntParam(pfx + "oversample", name + "Oversample", "Oversample", "", { 0.0, 3.0, 1.0, 1.0 }, 0.0f, 0.0f, oversampleTextFunction);
 }
 
 //==============================================================================
@@ -742,16 +765,18 @@ APAudioProcessor::APAudioProcessor() : gin::Processor(
 
 	formatManager.registerBasicFormats();
 
-	for (int i = 0; i < 8; i++) {
-		sampler.addVoice(new APSamplerVoice(*this));
-	}
-    
     setupModMatrix();
     init();
+
+    for (auto* param : latencyParams())
+        param->addListener(&latencyUpdater);
 }
 
 APAudioProcessor::~APAudioProcessor()
 {
+    latencyUpdater.cancelPendingUpdate();
+    for (auto* param : latencyParams())
+        param->removeListener(&latencyUpdater);
     MTS_DeregisterClient(client);
 	reader = nullptr;
 }
@@ -880,8 +905,13 @@ void APAudioProcessor::reset()
     lfo3.reset();
     lfo4.reset();
 
-    waveshaper.reset();
-    compressor.reset();
+    for (auto& lane : fxLanes) {
+        if (lane.isReady(1))
+            lane.waveshaper.reset();
+        lane.compressor.reset();
+        lane.latencyCompensation.reset();
+    }
+    auxLatencyCompensation.reset();
     
     
 }
@@ -896,15 +926,19 @@ void APAudioProcessor::prepareToPlay(double newSampleRate, int newSamplesPerBloc
     sampler.setCurrentPlaybackSampleRate(newSampleRate);
 	modMatrix.setSampleRate(newSampleRate);
 
-    stereoDelay.prepare(spec);
-    effectGain.prepare(spec);
-    waveshaper.prepare(spec);
-    compressor.setSampleRate(newSampleRate);
-    compressor.setNumChannels(2);
-    chorus.prepare(spec);
-    reverb.prepare(spec);
-    mbfilter.prepare(spec);
-    ringmod.prepare(spec);
+    // processBlock is where the lanes usually get the oversampling setting, but it
+    // sets the latency reported below, so they need it now. The lanes have the same
+    // effects, so either one's maximum latency is the most one lane waits for the other.
+    {
+        const juce::ScopedLock sl(lanePrepareLock);
+        const int maxLaneLatency = fxLanes[0].getMaxLatencySamples();
+        for (size_t i = 0; i < fxLanes.size(); i++) {
+            fxLanes[i].waveshaper.setOversampling(waveshaperParams.oversample->getUserValueInt());
+            fxLanes[i].prepare(spec, maxLaneLatency, laneEffects((int)i));
+        }
+        // with the lanes chained, the aux synth may wait out both of them
+        auxLatencyCompensation.prepare(spec, 2 * maxLaneLatency);
+    }
     limiter.prepare(spec);
     limiter.setThreshold(-0.3f);
     limiter.setRelease(0.05f);
@@ -923,6 +957,24 @@ void APAudioProcessor::prepareToPlay(double newSampleRate, int newSamplesPerBloc
     dcFilter.prepare(spec);
 
 	analogTables.setSampleRate(newSampleRate);
+
+    // everything processBlock writes to, sized up front so the audio thread doesn't allocate
+    sidechainBuffer.setSize(2, newSamplesPerBlock, false, false, true);
+    auxBuffer.setSize(2, newSamplesPerBlock, false, false, true);
+    samplerBuffer.setSize(2, newSamplesPerBlock, false, false, true);
+    fxBLaneBuffer.setSize(2, AP_MAX_CONTROL_BLOCK_SIZE, false, false, true);
+
+    updateTailLength();
+    updateLatency();
+}
+
+void APAudioProcessor::setStateInformation(const void* data, int sizeInBytes)
+{
+    Processor::setStateInformation(data, sizeInBytes);
+
+    // the host asks for the latency once the state is loaded, before the next processBlock
+    prepareLaneEffects();
+    updateLatency();
 }
 
 void APAudioProcessor::releaseResources()
@@ -932,23 +984,13 @@ void APAudioProcessor::releaseResources()
 void APAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midi)
 {
     juce::ScopedNoDenormals noDenormals;
+    const RealtimeAudit::ScopedRealtimeThread realtime;
 
     auto numSamples = buffer.getNumSamples();
 
 	//auxMidiBuffer.clear();
 	//auxMidiBuffer.addEvents(midi, 0, numSamples, 0);
 
-    if (MTS_HasMaster(client)) {
-        scaleName = MTS_GetScaleName(client);
-    }
-    
-	if (modMatrix.getLearn().id != -1) {
-		learningLabel = "Learning: " + modMatrix.getModSrcName(modMatrix.getLearn());
-	}
-	else {
-		learningLabel = "";
-	}
-
     if (presetLoaded)
     {
         presetLoaded = false;
@@ -981,21 +1023,34 @@ void APAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::Midi
     synth.setGlissando(globalParams.glideMode->getProcValue() == 1.0f);
     synth.setPortamento(globalParams.glideMode->getProcValue() == 2.0f);
     synth.setGlideRate(globalParams.glideRate->getProcValue());
-    synth.setNumVoices(int (globalParams.voices->getProcValue()));
+    const int numVoices = std::min(int(globalParams.voices->getProcValue()) << globalParams.voiceMult->getUserValueInt(), AP_MAX_VOICES);
+    synth.setNumVoices(numVoices);
 
 	auxSynth.setMono(globalParams.mono->isOn());
 	auxSynth.setLegato(globalParams.legato->isOn());
 	auxSynth.setGlissando(globalParams.glideMode->getProcValue() == 1.0f);
 	auxSynth.setPortamento(globalParams.glideMode->getProcValue() == 2.0f);
 	auxSynth.setGlideRate(globalParams.glideRate->getProcValue());
-	auxSynth.setNumVoices(int(globalParams.voices->getProcValue()));
+	auxSynth.setNumVoices(numVoices);
+	sampler.setNumVoices(numVoices);
 	auxBuffer.clear();
 
+    const int blockSize = controlBlockSize.load();
+    const bool adaptive = adaptiveControlBlocks.load();
+
     while (todo > 0)
     {
-        int thisBlock = std::min(todo, 32);
+        int thisBlock = nextSubBlockSize(midi, pos, todo, blockSize, adaptive);
 
         updateParams(thisBlock);
+
+        if (adaptive) {
+            // keep doubling the run while things are quiet, back to the control block size when they aren't
+            if (subBlockEndsAtNote || monoModulationChange() > adaptiveModThreshold)
+                adaptiveBlockSize = blockSize;
+            else
+                adaptiveBlockSize = std::min(adaptiveBlockSize * 2, AP_MAX_CONTROL_BLOCK_SIZE);
+        }
         
         sidechainSlice = gin::sliceBuffer(sidechainBuffer, pos, thisBlock);
 		if (auxParams.enable->isOn()) { auxSynth.renderNextBlock(auxBuffer, midi, pos, thisBlock); }
@@ -1019,6 +1074,7 @@ void APAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::Midi
 		if (!auxParams.prefx->isOn()) {
 			applyEffects(bufferSlice);
 			outputGain.process(auxSlice);
+			auxLatencyCompensation.process(auxSlice, getEffectsLatencySamples()); // line up with the FX output
 			bufferSlice.addFrom(0, 0, auxBuffer, 0, pos, thisBlock);
 			bufferSlice.addFrom(1, 0, auxBuffer, 1, pos, thisBlock);
 		}
@@ -1035,6 +1091,89 @@ void APAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::Midi
 
     synth.endBlock(numSamples);
 	auxSynth.endBlock(numSamples);
+
+    updateTailLength();
+}
+
+void APAudioProcessor::setControlBlockSize(int newSize)
+{
+    controlBlockSize = juce::jlimit(1, AP_MAX_CONTROL_BLOCK_SIZE, newSize);
+}
+
+void APAudioProcessor::setVoiceSilence(float thresholdDb, float holdMs)
+{
+    voiceSilenceGain = juce::Decibels::decibelsToGain(thresholdDb);
+    voiceSilenceMs = holdMs;
+}
+
+int APAudioProcessor::nextSubBlockSize(const juce::MidiBuffer& midi, int pos, int todo, int blockSize, bool adaptive)
+{
+    int size = std::min(todo, adaptive ? std::max(adaptiveBlockSize, blockSize) : blockSize);
+
+    // end the sub-block where the next note starts or stops, so the synth handles it on
+    // its own sample and the voice reads its parameters from there, rather than from
+    // wherever the control grid happens to fall
+    subBlockEndsAtNote = false;
+    for (auto it = midi.findNextSamplePosition(pos + 1); it != midi.cend(); ++it)
+    {
+        const auto metadata = *it;
+        if (metadata.samplePosition >= pos + size)
+            break;
+        // read the status bytes directly: building a MidiMessage can allocate for sysex
+        const auto status = metadata.data[0] & 0xf0;
+        const bool allOff = status == 0xb0 && metadata.numBytes > 1 && (metadata.data[1] == 120 || metadata.data[1] == 123);
+        if (status == 0x80 || status == 0x90 || allOff)
+        {
+            size = metadata.samplePosition - pos;
+            subBlockEndsAtNote = true;
+            break;
+        }
+    }
+
+    // a long adaptive run also ends where a mono LFO moves away from its starting value,
+    // so a step or a fast sweep partway through gets a sub-block boundary of its own
+    if (adaptive && size > blockSize)
+        size = monoModulationSplit(blockSize, size);
+
+    return size;
+}
+
+int APAudioProcessor::monoModulationSplit(int minSize, int size)
+{
+    // run copies of the LFOs ahead, one sample at a time, to find the first sample where
+    // any of them has moved by more than adaptiveModThreshold; runs never end before
+    // minSize, so the adaptive path never splits finer than the fixed one
+    std::array<gin::LFO, 4> probes{ lfo1, lfo2, lfo3, lfo4 };
+    std::array<float, 4> start{};
+    for (size_t i = 0; i < probes.size(); i++)
+        start[i] = probes[i].getOutput();
+
+    for (int n = 1; n < size; n++)
+    {
+        for (size_t i = 0; i < probes.size(); i++)
+        {
+            probes[i].process(1);
+            if (std::abs(probes[i].getOutput() - start[i]) > adaptiveModThreshold)
+                return std::max(n, minSize);
+        }
+    }
+    return size;
+}
+
+float APAudioProcessor::monoModulationChange()
+{
+    const std::array<float, 8> values{
+        lfo1.getOutput(), lfo2.getOutput(), lfo3.getOutput(), lfo4.getOutput(),
+        modMatrix.getValue(macroParams.macro1), modMatrix.getValue(macroParams.macro2),
+        modMatrix.getValue(macroParams.macro3), modMatrix.getValue(macroParams.macro4)
+    };
+
+    float change = 0.0f;
+    for (size_t i = 0; i < values.size(); i++)
+        change = std::max(change, std::abs(values[i] - lastMonoModValues[i]));
+
+    lastMonoModValues = values;
+    return change;
 }
 
 juce::Array<float> APAudioProcessor::getLiveFilterCutoff()
@@ -1145,9 +1284,6 @@ void APAudioProcessor::applyEffects(juce::AudioSampleBuffer& fxALaneBuffer)
 
     // case 1: lane A feeds into lane B
     if (fxOrderParams.chainAtoB->isOn()) {
-        auto outBlock = juce::dsp::AudioBlock<float>(fxALaneBuffer);
-        auto outContext = juce::dsp::ProcessContextReplacing<float>(outBlock);
-
         if (laneAPre) {
             laneAFilter.process(fxALaneBuffer);
             float gain = juce::Decibels::decibelsToGain(fxOrderParams.laneAGain->getUserValue());
@@ -1155,41 +1291,8 @@ void APAudioProcessor::applyEffects(juce::AudioSampleBuffer& fxALaneBuffer)
             fxALaneBuffer.applyGain(1, 0, numSamples, gain * std::min(1 + laneAPan, 1.0f));
         }
 
-        for (int fx : {fxa1, fxa2, fxa3, fxa4} )
-        {
-            switch (fx)
-            {
-            case 0:
-                break;
-            case 1:
-                waveshaper.process(outContext);
-                break;
-            case 2:
-                compressor.process(fxALaneBuffer);
-                break;
-            case 3:
-                stereoDelay.process(outContext);
-                break;
-            case 4:
-                chorus.process(outContext);
-                break;
-            case 5:
-                mbfilter.process(outContext);
-                break;
-            case 6:
-                reverb.process(outContext);
-                break;
-            case 7:
-                ringmod.process(outContext);
-                break;
-            case 8:
-                effectGain.process(outContext);
-                break;
-            default:
-                break;
-            }
-
-        }
+        for (int fx : { fxa1, fxa2, fxa3, fxa4 })
+            processEffect(fx, fxLanes[0], fxALaneBuffer);
 
         if (!laneAPre) {
             laneAFilter.process(fxALaneBuffer);
@@ -1205,40 +1308,8 @@ void APAudioProcessor::applyEffects(juce::AudioSampleBuffer& fxALaneBuffer)
             fxALaneBuffer.applyGain(1, 0, numSamples, gain * std::min(1 + laneBPan, 1.0f));
         }
 
-        for (int fx : {fxb1, fxb2, fxb3, fxb4})
-        {
-            switch (fx)
-            {
-            case 0:
-                break;
-            case 1:
-                waveshaper.process(outContext);
-                break;
-            case 2:
-                compressor.process(fxALaneBuffer);
-                break;
-            case 3:
-                stereoDelay.process(outContext);
-                break;
-            case 4:
-                chorus.process(outContext);
-                break;
-            case 5:
-                mbfilter.process(outContext);
-                break;
-            case 6:
-                reverb.process(outContext);
-                break;
-            case 7:
-                ringmod.process(outContext);
-                break;
-            case 8:
-                effectGain.process(outContext);
-                break;
-            default:
-                break;
-            }
-        }
+        for (int fx : { fxb1, fxb2, fxb3, fxb4 })
+            processEffect(fx, fxLanes[1], fxALaneBuffer);
 
         if (!laneBPre) {
             laneBFilter.process(fxALaneBuffer);
@@ -1249,108 +1320,64 @@ void APAudioProcessor::applyEffects(juce::AudioSampleBuffer& fxALaneBuffer)
     }
     // case 2: lanes A and B are run in parallel
     else {
-        juce::AudioBuffer<float> fxBLaneBuffer;
-        fxBLaneBuffer.makeCopyOf(fxALaneBuffer);
-
-        if (laneAPre) {
-            laneAFilter.process(fxALaneBuffer);
-            float gain = juce::Decibels::decibelsToGain(fxOrderParams.laneAGain->getUserValue());
-            fxALaneBuffer.applyGain(0, 0, numSamples, gain * 0.5f * std::min(1 - laneAPan, 1.0f));
-            fxALaneBuffer.applyGain(1, 0, numSamples, gain * 0.5f * std::min(1 + laneAPan, 1.0f));
-        }
-        
-        if (laneBPre) {
-            laneBFilter.process(fxBLaneBuffer);
-            float gain = juce::Decibels::decibelsToGain(fxOrderParams.laneBGain->getUserValue());
-            fxBLaneBuffer.applyGain(0, 0, numSamples, gain * 0.5f * std::min(1 - laneBPan, 1.0f));
-            fxBLaneBuffer.applyGain(1, 0, numSamples, gain * 0.5f * std::min(1 + laneBPan, 1.0f));
-        }
-        
-        auto ABlock = juce::dsp::AudioBlock<float>(fxALaneBuffer);
-        auto AContext = juce::dsp::ProcessContextReplacing<float>(ABlock);
-        auto BBlock = juce::dsp::AudioBlock<float>(fxBLaneBuffer);
-        auto BContext = juce::dsp::ProcessContextReplacing<float>(BBlock);
-        for (int fx : {fxa1, fxa2, fxa3, fxa4})
-        {
-            switch (fx)
-            {
-            case 0:
-                break;
-            case 1:
-                waveshaper.process(AContext);
-                break;
-            case 2:
-                compressor.process(fxALaneBuffer);
-                break;
-            case 3:
-                stereoDelay.process(AContext);
-                break;
-            case 4:
-                chorus.process(AContext);
-                break;
-            case 5:
-                mbfilter.process(AContext);
-                break;
-            case 6:
-                reverb.process(AContext);
-                break;
-            case 7:
-                ringmod.process(AContext);
-                break;
-            case 8:
-                effectGain.process(AContext);
-                break;
-            default:
-                break;
+        fxBLaneBuffer.setSize(2, numSamples, false, false, true);
+        fxBLaneBuffer.copyFrom(0, 0, fxALaneBuffer, 0, 0, numSamples);
+        fxBLaneBuffer.copyFrom(1, 0, fxALaneBuffer, 1, 0, numSamples);
+
+        const int laneALatency = getLaneLatencySamples(0);
+        const int laneBLatency = getLaneLatencySamples(1);
+        const int totalLatency = std::max(laneALatency, laneBLatency);
+
+        // the lanes share nothing but their (read-only) settings, so B can run on another thread
+        auto processLane = [&](int lane) {
+            if (lane == 0) {
+                if (laneAPre) {
+                    laneAFilter.process(fxALaneBuffer);
+                    float gain = juce::Decibels::decibelsToGain(fxOrderParams.laneAGain->getUserValue());
+                    fxALaneBuffer.applyGain(0, 0, numSamples, gain * 0.5f * std::min(1 - laneAPan, 1.0f));
+                    fxALaneBuffer.applyGain(1, 0, numSamples, gain * 0.5f * std::min(1 + laneAPan, 1.0f));
+                }
+
+                for (int fx : { fxa1, fxa2, fxa3, fxa4 })
+                    processEffect(fx, fxLanes[0], fxALaneBuffer);
+
+                if (!laneAPre) {
+                    laneAFilter.process(fxALaneBuffer);
+                    float gain = juce::Decibels::decibelsToGain(fxOrderParams.laneAGain->getUserValue());
+                    fxALaneBuffer.applyGain(0, 0, numSamples, gain * 0.5f * std::min(1 - laneAPan, 1.0f));
+                    fxALaneBuffer.applyGain(1, 0, numSamples, gain * 0.5f * std::min(1 + laneAPan, 1.0f));
+                }
+
+                fxLanes[0].compensate(fxALaneBuffer, totalLatency - laneALatency);
             }
-        }
-        for (int fx : { fxb1, fxb2, fxb3, fxb4 })
-        {
-            switch (fx)
-            {
-            case 0:
-                break;
-            case 1:
-                waveshaper.process(BContext);
-                break;
-            case 2:
-                compressor.process(fxBLaneBuffer);
-                break;
-            case 3:
-                stereoDelay.process(BContext);
-                break;
-            case 4:
-                chorus.process(BContext);
-                break;
-            case 5:
-                mbfilter.process(BContext);
-                break;
-            case 6:
-                reverb.process(BContext);
-                break;
-            case 7:
-                ringmod.process(BContext);
-                break;
-            case 8:
-                effectGain.process(BContext);
-                break;
-            default:
-                break;
+            else {
+                if (laneBPre) {
+                    laneBFilter.process(fxBLaneBuffer);
+                    float gain = juce::Decibels::decibelsToGain(fxOrderParams.laneBGain->getUserValue());
+                    fxBLaneBuffer.applyGain(0, 0, numSamples, gain * 0.5f * std::min(1 - laneBPan, 1.0f));
+                    fxBLaneBuffer.applyGain(1, 0, numSamples, gain * 0.5f * std::min(1 + laneBPan, 1.0f));
+                }
+
+                for (int fx : { fxb1, fxb2, fxb3, fxb4 })
+                    processEffect(fx, fxLanes[1], fxBLaneBuffer);
+
+                if (!laneBPre) {
+                    laneBFilter.process(fxBLaneBuffer);
+                    float gain = juce::Decibels::decibelsToGain(fxOrderParams.laneBGain->getUserValue());
+                    fxBLaneBuffer.applyGain(0, 0, numSamples, gain * 0.5f * std::min(1 - laneBPan, 1.0f));
+                    fxBLaneBuffer.applyGain(1, 0, numSamples, gain * 0.5f * std::min(1 + laneBPan, 1.0f));
+                }
+
+                fxLanes[1].compensate(fxBLaneBuffer, totalLatency - laneBLatency);
             }
-        }
+        };
 
-        if (!laneAPre) {
-            laneAFilter.process(fxALaneBuffer);
-            float gain = juce::Decibels::decibelsToGain(fxOrderParams.laneAGain->getUserValue());
-            fxALaneBuffer.applyGain(0, 0, numSamples, gain * 0.5f * std::min(1 - laneAPan, 1.0f));
-            fxALaneBuffer.applyGain(1, 0, numSamples, gain * 0.5f * std::min(1 + laneAPan, 1.0f));
+        if (parallelFXLanes.load()) {
+            voicePool.run(2, processLane);
         }
-
-        if (!laneBPre) {
-            laneBFilter.process(fxBLaneBuffer);
-            float gain = juce::Decibels::decibelsToGain(fxOrderParams.laneBGain->getUserValue());
-            fxBLaneBuffer.applyGain(0, 0, numSamples, gain * 0.5f * std::min(1 - laneBPan, 1.0f));
-            fxBLaneBuffer.applyGain(1, 0, numSamples, gain * 0.5f * std::min(1 + laneBPan, 1.0f));
+        else {
+            processLane(0);
+            processLane(1);
         }
 
         fxALaneBuffer.addFrom(0, 0, fxBLaneBuffer, 0, 0, numSamples);
@@ -1364,6 +1391,167 @@ void APAudioProcessor::applyEffects(juce::AudioSampleBuffer& fxALaneBuffer)
     limiter.process(AContext);
 }
 
+// fx is the index used by the FX order params: 0 is an empty slot
+void APAudioProcessor::processEffect(int fx, FXLane& lane, juce::AudioSampleBuffer& laneBuffer)
+{
+    if (fx < 1 || fx >= numEffectTypes || !lane.isReady(fx))
+        return; // empty, or just put in the slot and not prepared yet
+    if (lane.effectIdle[(size_t)fx].canSkip(laneBuffer, getEffectTailSeconds(fx, lane), getSampleRate()))
+        return;
+
+    auto block = juce::dsp::AudioBlock<float>(laneBuffer);
+    auto context = juce::dsp::ProcessContextReplacing<float>(block);
+    switch (fx)
+    {
+    case 1:
+        lane.waveshaper.process(context);
+        break;
+    case 2:
+        lane.compressor.process(laneBuffer);
+        break;
+    case 3:
+        lane.stereoDelay.process(context);
+        break;
+    case 4:
+        lane.chorus.process(context);
+        break;
+    case 5:
+        lane.mbfilter.process(context);
+        break;
+    case 6:
+        lane.reverb.process(context);
+        break;
+    case 7:
+        lane.ringmod.process(context);
+        break;
+    case 8:
+        lane.effectGain.process(context);
+        break;
+    default:
+        break;
+    }
+}
+
+double APAudioProcessor::getEffectTailSeconds(int fx, const FXLane& lane) const
+{
+    if (fx < 1 || fx >= numEffectTypes || !lane.isReady(fx))
+        return 0.0;
+    switch (fx)
+    {
+    case 1:
+        return lane.waveshaper.getTailLengthSeconds();
+    case 2: // let the detector release fully
+        return compressorParams.attack->getProcValue() + compressorParams.release->getProcValue() * 5.0;
+    case 3:
+        return lane.stereoDelay.getTailLengthSeconds();
+    case 4:
+        return lane.chorus.getTailLengthSeconds();
+    case 5:
+        return lane.mbfilter.getTailLengthSeconds();
+    case 6:
+        return lane.reverb.getTailLengthSeconds();
+    case 7:
+        return lane.ringmod.getTailLengthSeconds();
+    default:
+        return 0.0;
+    }
+}
+
+// reads the lanes' effects, so it's called where they're set: on the audio thread, and in
+// prepareToPlay; the host reads the result from any thread through getTailLengthSeconds
+void APAudioProcessor::updateTailLength()
+{
+    auto laneTail = [this](const FXLane& lane, std::initializer_list<gin::Parameter::Ptr> slots) {
+        double tail = 0.0;
+        for (auto slot : slots)
+            tail += getEffectTailSeconds(slot->getUserValueInt(), lane);
+        return tail;
+    };
+    double laneA = laneTail(fxLanes[0], { fxOrderParams.fxa1, fxOrderParams.fxa2, fxOrderParams.fxa3, fxOrderParams.fxa4 });
+    double laneB = laneTail(fxLanes[1], { fxOrderParams.fxb1, fxOrderParams.fxb2, fxOrderParams.fxb3, fxOrderParams.fxb4 });
+    tailSeconds = fxOrderParams.chainAtoB->isOn() ? laneA + laneB : std::max(laneA, laneB);
+}
+
+double APAudioProcessor::getTailLengthSeconds() const
+{
+    return tailSeconds.load();
+}
+
+int APAudioProcessor::getEffectLatencySamples(int fx, const FXLane& lane) const
+{
+    if (fx < 1 || fx >= numEffectTypes || !lane.isReady(fx))
+        return 0;
+    switch (fx)
+    {
+    case 1: // when oversampling
+        return lane.waveshaper.getLatencySamples();
+    case 7: // always oversampled
+        return lane.ringmod.getLatencySamples();
+    default: // the compressor has no lookahead, the filters are IIR, and the delay,
+             // chorus and reverb only delay the wet signal
+        return 0;
+    }
+}
+
+int APAudioProcessor::getLaneLatencySamples(int lane) const
+{
+    const auto& p = fxOrderParams;
+    const auto slots = lane == 0 ? std::array{ p.fxa1, p.fxa2, p.fxa3, p.fxa4 } : std::array{ p.fxb1, p.fxb2, p.fxb3, p.fxb4 };
+    int latency = 0;
+    for (auto slot : slots)
+        latency += getEffectLatencySamples(slot->getUserValueInt(), fxLanes[(size_t)lane]);
+    return latency;
+}
+
+int APAudioProcessor::getEffectsLatencySamples() const
+{
+    int laneA = getLaneLatencySamples(0);
+    int laneB = getLaneLatencySamples(1);
+    // in parallel, the lane with less latency is delayed to match the other
+    return fxOrderParams.chainAtoB->isOn() ? laneA + laneB : std::max(laneA, laneB);
+}
+
+// on the message thread: setLatencySamples tells the host, which isn't safe from the audio thread
+void APAudioProcessor::updateLatency()
+{
+    // processBlock passes the oversampling on too, but the host may ask before the next one
+    for (auto& lane : fxLanes)
+        lane.waveshaper.setOversampling(waveshaperParams.oversample->getUserValueInt());
+
+    const int latency = getEffectsLatencySamples();
+    if (latency != getLatencySamples())
+        setLatencySamples(latency);
+}
+
+APAudioProcessor::EffectSet APAudioProcessor::laneEffects(int lane) const
+{
+    const auto& p = fxOrderParams;
+    const auto slots = lane == 0 ? std::array{ p.fxa1, p.fxa2, p.fxa3, p.fxa4 } : std::array{ p.fxb1, p.fxb2, p.fxb3, p.fxb4 };
+    EffectSet inSlots{};
+    for (auto slot : slots) {
+        const int fx = slot->getUserValueInt();
+        if (fx >= 1 && fx < numEffectTypes)
+            inSlots[(size_t)fx] = true;
+    }
+    return inSlots;
+}
+
+// off the audio thread, when the slots change: prepares the effects a lane hasn't used
+// since prepareToPlay. Until then the lane passes its signal straight past them.
+void APAudioProcessor::prepareLaneEffects()
+{
+    const juce::ScopedLock sl(lanePrepareLock);
+    for (size_t i = 0; i < fxLanes.size(); i++)
+        fxLanes[i].prepareEffects(laneEffects((int)i));
+}
+
+std::vector<gin::Parameter*> APAudioProcessor::latencyParams() const
+{
+    return { waveshaperParams.oversample, fxOrderParams.chainAtoB,
+        fxOrderParams.fxa1, fxOrderParams.fxa2, fxOrderParams.fxa3, fxOrderParams.fxa4,
+        fxOrderParams.fxb1, fxOrderParams.fxb2, fxOrderParams.fxb3, fxOrderParams.fxb4 };
+}
+
 void APAudioProcessor::loadSample(const juce::String& path)
 {    
 	sampler.loadSound(path);
@@ -1411,72 +1599,8 @@ void APAudioProcessor::updateParams(int newBlockSize)
     modMatrix.setMonoValue(macroSrc3, modMatrix.getValue(macroParams.macro3));
     modMatrix.setMonoValue(macroSrc4, modMatrix.getValue(macroParams.macro4));
 
-    effectGain.setGainLevel(modMatrix.getValue(gainParams.gain));
-
-    waveshaper.setGain(modMatrix.getValue(waveshaperParams.drive), modMatrix.getValue(waveshaperParams.gain));
-    waveshaper.setDry(modMatrix.getValue(waveshaperParams.dry));
-    waveshaper.setWet(modMatrix.getValue(waveshaperParams.wet));
-    waveshaper.setFunctionToUse(int(waveshaperParams.type->getValue()));
-    waveshaper.setHighShelfFreqAndQ(modMatrix.getValue(waveshaperParams.highshelf), modMatrix.getValue(waveshaperParams.hsq));
-    waveshaper.setLPCutoff(modMatrix.getValue(waveshaperParams.lp));
-
-    compressor.setParams(
-        modMatrix.getValue(compressorParams.attack),
-        0.0f,
-        modMatrix.getValue(compressorParams.release),
-        modMatrix.getValue(compressorParams.threshold),
-        modMatrix.getValue(compressorParams.ratio),
-        modMatrix.getValue(compressorParams.knee)
-    );
-    compressor.setInputGain(modMatrix.getValue(compressorParams.input));
-    compressor.setOutputGain(modMatrix.getValue(compressorParams.output));
-    compressor.setMode((gin::Dynamics::Type)(int)compressorParams.type->getValue());
-
     auto& notes = gin::NoteDuration::getNoteDurations();
 
-    bool tempoSync = stereoDelayParams.temposync->getProcValue() > 0.0f;
-    if (!tempoSync) {
-        stereoDelay.setTimeL(modMatrix.getValue(stereoDelayParams.timeleft));
-        stereoDelay.setTimeR(modMatrix.getValue(stereoDelayParams.timeright));
-    }
-    else {
-        stereoDelay.setTimeL(notes[size_t(modMatrix.getValue(stereoDelayParams.beatsleft))].toSeconds(playhead));
-        stereoDelay.setTimeR(notes[size_t(modMatrix.getValue(stereoDelayParams.beatsright))].toSeconds(playhead));
-    }
-    stereoDelay.setFB(modMatrix.getValue(stereoDelayParams.feedback));
-    stereoDelay.setWet(modMatrix.getValue(stereoDelayParams.wet));
-    stereoDelay.setDry(modMatrix.getValue(stereoDelayParams.dry));
-    stereoDelay.setFreeze(stereoDelayParams.freeze->getProcValue() > 0.0f);
-    stereoDelay.setPing(stereoDelayParams.pingpong->getProcValue() > 0.0f);
-    stereoDelay.setCutoff(modMatrix.getValue(stereoDelayParams.cutoff));
-
-    chorus.setRate(modMatrix.getValue(chorusParams.rate));
-    chorus.setDepth(modMatrix.getValue(chorusParams.depth));
-    chorus.setCentreDelay(modMatrix.getValue(chorusParams.delay));
-    chorus.setFeedback(modMatrix.getValue(chorusParams.feedback));
-    chorus.setWet(modMatrix.getValue(chorusParams.wet));
-    chorus.setDry(modMatrix.getValue(chorusParams.dry));
-
-    reverb.setSize(modMatrix.getValue(reverbParams.size));
-    reverb.setDecay(modMatrix.getValue(reverbParams.decay));
-    reverb.setDamping(modMatrix.getValue(reverbParams.damping));
-    reverb.setLowpass(modMatrix.getValue(reverbParams.lowpass));
-    reverb.setPredelay(modMatrix.getValue(reverbParams.predelay));
-    reverb.setDry(modMatrix.getValue(reverbParams.dry));
-    reverb.setWet(modMatrix.getValue(reverbParams.wet));
-
-    mbfilter.setParams(
-        modMatrix.getValue(mbfilterParams.lowshelffreq),
-        modMatrix.getValue(mbfilterParams.lowshelfgain),
-        modMatrix.getValue(mbfilterParams.lowshelfq),
-        modMatrix.getValue(mbfilterParams.peakfreq),
-        modMatrix.getValue(mbfilterParams.peakgain),
-        modMatrix.getValue(mbfilterParams.peakq),
-        modMatrix.getValue(mbfilterParams.highshelffreq),
-        modMatrix.getValue(mbfilterParams.highshelfgain),
-        modMatrix.getValue(mbfilterParams.highshelfq)
-    );
-
     RingModulator::RingModParams rmparams;
     rmparams.mod1freq = modMatrix.getValue(ringmodParams.modfreq1);
     rmparams.shape1 = modMatrix.getValue(ringmodParams.shape1);
@@ -1487,7 +1611,98 @@ void APAudioProcessor::updateParams(int newBlockSize)
     rmparams.spread = modMatrix.getValue(ringmodParams.spread);
     rmparams.lowcut = modMatrix.getValue(ringmodParams.lowcut);
     rmparams.highcut = modMatrix.getValue(ringmodParams.highcut);
-    ringmod.setParams(rmparams);
+
+    // only the effects in a lane's slots are set: the rest aren't running, and the
+    // deferred ones may not have been prepared
+    for (size_t i = 0; i < fxLanes.size(); i++)
+    {
+        auto& lane = fxLanes[i];
+        const auto inSlots = laneEffects((int)i);
+        auto uses = [&](int fx) { return inSlots[(size_t)fx] && lane.isReady(fx); };
+
+        lane.waveshaper.setOversampling(waveshaperParams.oversample->getUserValueInt());
+
+        if (uses(8)) {
+            lane.effectGain.setGainLevel(modMatrix.getValue(gainParams.gain));
+        }
+
+        if (uses(1)) {
+            lane.waveshaper.setGain(modMatrix.getValue(waveshaperParams.drive), modMatrix.getValue(waveshaperParams.gain));
+            lane.waveshaper.setDry(modMatrix.getValue(waveshaperParams.dry));
+            lane.waveshaper.setWet(modMatrix.getValue(waveshaperParams.wet));
+            lane.waveshaper.setFunctionToUse(int(waveshaperParams.type->getValue()));
+            lane.waveshaper.setHighShelfFreqAndQ(modMatrix.getValue(waveshaperParams.highshelf), modMatrix.getValue(waveshaperParams.hsq));
+            lane.waveshaper.setLPCutoff(modMatrix.getValue(waveshaperParams.lp));
+        }
+
+        if (uses(2)) {
+            lane.compressor.setParams(
+                modMatrix.getValue(compressorParams.attack),
+                0.0f,
+                modMatrix.getValue(compressorParams.release),
+                modMatrix.getValue(compressorParams.threshold),
+                modMatrix.getValue(compressorParams.ratio),
+                modMatrix.getValue(compressorParams.knee)
+            );
+            lane.compressor.setInputGain(modMatrix.getValue(compressorParams.input));
+            lane.compressor.setOutputGain(modMatrix.getValue(compressorParams.output));
+            lane.compressor.setMode((gin::Dynamics::Type)(int)compressorParams.type->getValue());
+        }
+
+        if (uses(3)) {
+            bool tempoSync = stereoDelayParams.temposync->getProcValue() > 0.0f;
+            if (!tempoSync) {
+                lane.stereoDelay.setTimeL(modMatrix.getValue(stereoDelayParams.timeleft));
+                lane.stereoDelay.setTimeR(modMatrix.getValue(stereoDelayParams.timeright));
+            }
+            else {
+                lane.stereoDelay.setTimeL(notes[size_t(modMatrix.getValue(stereoDelayParams.beatsleft))].toSeconds(playhead));
+                lane.stereoDelay.setTimeR(notes[size_t(modMatrix.getValue(stereoDelayParams.beatsright))].toSeconds(playhead));
+            }
+            lane.stereoDelay.setFB(modMatrix.getValue(stereoDelayParams.feedback));
+            lane.stereoDelay.setWet(modMatrix.getValue(stereoDelayParams.wet));
+            lane.stereoDelay.setDry(modMatrix.getValue(stereoDelayParams.dry));
+            lane.stereoDelay.setFreeze(stereoDelayParams.freeze->getProcValue() > 0.0f);
+            lane.stereoDelay.setPing(stereoDelayParams.pingpong->getProcValue() > 0.0f);
+            lane.stereoDelay.setCutoff(modMatrix.getValue(stereoDelayParams.cutoff));
+        }
+
+        if (uses(4)) {
+            lane.chorus.setRate(modMatrix.getValue(chorusParams.rate));
+            lane.chorus.setDepth(modMatrix.getValue(chorusParams.depth));
+            lane.chorus.setCentreDelay(modMatrix.getValue(chorusParams.delay));
+            lane.chorus.setFeedback(modMatrix.getValue(chorusParams.feedback));
+            lane.chorus.setWet(modMatrix.getValue(chorusParams.wet));
+            lane.chorus.setDry(modMatrix.getValue(chorusParams.dry));
+        }
+
+        if (uses(6)) {
+            lane.reverb.setSize(modMatrix.getValue(reverbParams.size));
+            lane.reverb.setDecay(modMatrix.getValue(reverbParams.decay));
+            lane.reverb.setDamping(modMatrix.getValue(reverbParams.damping));
+            lane.reverb.setLowpass(modMatrix.getValue(reverbParams.lowpass));
+            lane.reverb.setPredelay(modMatrix.getValue(reverbParams.predelay));
+            lane.reverb.setDry(modMatrix.getValue(reverbParams.dry));
+            lane.reverb.setWet(modMatrix.getValue(reverbParams.wet));
+        }
+
+        if (uses(5)) {
+            lane.mbfilter.setParams(
+                modMatrix.getValue(mbfilterParams.lowshelffreq),
+                modMatrix.getValue(mbfilterParams.lowshelfgain),
+                modMatrix.getValue(mbfilterParams.lowshelfq),
+                modMatrix.getValue(mbfilterParams.peakfreq),
+                modMatrix.getValue(mbfilterParams.peakgain),
+                modMatrix.getValue(mbfilterParams.peakq),
+                modMatrix.getValue(mbfilterParams.highshelffreq),
+                modMatrix.getValue(mbfilterParams.highshelfgain),
+                modMatrix.getValue(mbfilterParams.highshelfq)
+            );
+        }
+
+        if (uses(7))
+            lane.ringmod.setParams(rmparams);
+    }
 
     // Output gain
     outputGain.setGain(modMatrix.getValue(globalParams.level));
@@ -21,6 +21,9 @@
 #include "Synth.h"
 #include "AuxSynth.h"
 #include "APSampler.h"
+#include "ControlBlock.h"
+#include "SilenceDetector.h"
+#include "RealtimeAudit.h"
 
 //==============================================================================
 class APAudioProcessor : public gin::Processor
@@ -48,15 +51,60 @@ public:
 
 	void stateUpdated() override;
 	void updateState() override;
+	void setStateInformation(const void* data, int sizeInBytes) override;
 
     void updatePitchbend();
+
+    // samples per control-rate sub-block, clamped to [1, AP_MAX_CONTROL_BLOCK_SIZE];
+    // takes effect from the next processBlock
+    void setControlBlockSize(int newSize);
+    int getControlBlockSize() const { return controlBlockSize.load(); }
+
+    // let sub-blocks grow past the control block size, up to AP_MAX_CONTROL_BLOCK_SIZE,
+    // while no notes start or stop and the mono modulation sources hold steady
+    void setAdaptiveControlBlocks(bool shouldAdapt) { adaptiveControlBlocks = shouldAdapt; }
+    bool getAdaptiveControlBlocks() const { return adaptiveControlBlocks.load(); }
+
+    // render each synth's voices across this many worker threads as well as the
+    // audio thread; 0 (the default) renders them serially. pinToCores pins the workers
+    // to cores 1..numThreads (see RealtimeWorkerPool). Not for the audio thread.
+    void setVoiceRenderThreads(int numThreads, bool pinToCores = false) { voicePool.setNumThreads(juce::jlimit(0, 16, numThreads), pinToCores); }
+    int getVoiceRenderThreads() const { return voicePool.getNumThreads(); }
+
+    // when the FX lanes run in parallel (chainAtoB off), process lane B on one of the
+    // voice render threads while the audio thread does lane A
+    void setParallelFXLanes(bool shouldRunInParallel) { parallelFXLanes = shouldRunInParallel; }
+    bool getParallelFXLanes() const { return parallelFXLanes.load(); }
+
+    // released voices end once their output has stayed below thresholdDb for
+    // holdMs; holdMs <= 0 lets them run until their envelopes finish
+    void setVoiceSilence(float thresholdDb, float holdMs);
+    float getVoiceSilenceThreshold() const { return voiceSilenceGain.load(); }
+    float getVoiceSilenceMs() const { return voiceSilenceMs.load(); }
+
+    int nextSubBlockSize(const juce::MidiBuffer& midi, int pos, int todo, int blockSize, bool adaptive);
+    int monoModulationSplit(int minSize, int size);
+    float monoModulationChange();
     
     //==============================================================================
     
     //==============================================================================
     juce::Array<float> getLiveFilterCutoff();
 
+    static constexpr int numEffectTypes = 9; // including the empty slot
+    using EffectSet = std::array<bool, numEffectTypes>; // indexed like the FX order params
+    struct FXLane;
     void applyEffects(juce::AudioSampleBuffer& buffer);
+    void processEffect(int fx, FXLane& lane, juce::AudioSampleBuffer& laneBuffer);
+    double getEffectTailSeconds(int fx, const FXLane& lane) const;
+    double getTailLengthSeconds() const override;
+    void updateTailLength();
+    int getEffectLatencySamples(int fx, const FXLane& lane) const;
+    int getLaneLatencySamples(int lane) const;
+    int getEffectsLatencySamples() const;
+    void updateLatency();
+    EffectSet laneEffects(int lane) const;
+    void prepareLaneEffects();
 
     // Voice Params
     struct OSCParams
@@ -129,7 +177,7 @@ public:
     {
         GlobalParams() = default;
 
-        gin::Parameter::Ptr mono, glideMode, glideRate, legato, level, voices, mpe, velSens, pitchbendRange, sidechainEnable, squash;
+        gin::Parameter::Ptr mono, glideMode, glideRate, legato, level, voices, voiceMult, mpe, velSens, pitchbendRange, sidechainEnable, squash;
 
         void setup(APAudioProcessor& p);
 
@@ -151,7 +199,7 @@ public:
 	{
 		WaveshaperParams() = default;
 
-		gin::Parameter::Ptr enable, drive, gain, type, dry, wet, highshelf, hsq, lp;
+		gin::Parameter::Ptr enable, drive, gain, type, dry, wet, highshelf, hsq, lp, oversample;
 
 		void setup(APAudioProcessor& p);
         int pos{-1};
@@ -315,14 +363,108 @@ public:
 	SamplerParams samplerParams;
 
     //==============================================================================
-	GainProcessor effectGain;
-	WaveShaperProcessor waveshaper;
-	gin::Dynamics compressor;
-	StereoDelayProcessor stereoDelay;
-	ChorusProcessor chorus;
-	PlateReverb<float, uint32_t> reverb;
-	MBFilterProcessor mbfilter;
-	RingModulator ringmod;
+
+	// a whole-sample delay that lines a signal up with a path that has more latency
+	struct LatencyCompensation
+	{
+		void prepare(const juce::dsp::ProcessSpec& spec, int maxDelaySamples)
+		{
+			delayLine.setMaximumDelayInSamples(maxDelaySamples + 1);
+			delayLine.prepare(spec);
+			delaySamples = 0;
+		}
+
+		void process(juce::AudioSampleBuffer& buffer, int newDelaySamples)
+		{
+			if (newDelaySamples != delaySamples) {
+				delaySamples = newDelaySamples;
+				delayLine.setDelay((float)delaySamples);
+				delayLine.reset();
+			}
+			if (delaySamples > 0) {
+				auto block = juce::dsp::AudioBlock<float>(buffer);
+				delayLine.process(juce::dsp::ProcessContextReplacing<float>(block));
+			}
+		}
+
+		void reset() { delayLine.reset(); }
+
+		juce::dsp::DelayLine<float, juce::dsp::DelayLineInterpolationTypes::None> delayLine;
+		int delaySamples{ 0 };
+	};
+
+	// each FX lane has its own effects, so the lanes share no state and can run side by side.
+	// The waveshaper, reverb and ring modulator hold most of the memory (oversampling buffers
+	// and delay lines), so they're only prepared once the lane's slots use them; until then
+	// isReady() is false and the audio thread leaves them alone.
+	struct FXLane
+	{
+		// maxLatencySamples covers the other lane too, which this one may be delayed to match
+		void prepare(const juce::dsp::ProcessSpec& spec, int maxLatencySamples, const EffectSet& inSlots)
+		{
+			laneSpec = spec;
+			stereoDelay.prepare(spec);
+			effectGain.prepare(spec);
+			compressor.setSampleRate(spec.sampleRate);
+			compressor.setNumChannels(2);
+			chorus.prepare(spec);
+			mbfilter.prepare(spec);
+			for (int fx = 0; fx < numEffectTypes; fx++)
+				ready[(size_t)fx] = !isDeferred(fx);
+			for (auto& idle : effectIdle)
+				idle.reset();
+			prepareEffects(inSlots);
+			latencyCompensation.prepare(spec, maxLatencySamples);
+		}
+
+		// prepares the deferred effects in inSlots that aren't ready yet; not for the audio thread
+		void prepareEffects(const EffectSet& inSlots)
+		{
+			if (laneSpec.sampleRate <= 0.0)
+				return; // not prepared yet
+			for (int fx = 0; fx < numEffectTypes; fx++) {
+				if (!inSlots[(size_t)fx] || isReady(fx))
+					continue;
+				switch (fx) {
+				case 1: waveshaper.prepare(laneSpec); break;
+				case 6: reverb.prepare(laneSpec); break;
+				case 7: ringmod.prepare(laneSpec); break;
+				default: break;
+				}
+				ready[(size_t)fx].store(true, std::memory_order_release);
+			}
+		}
+
+		bool isReady(int fx) const { return ready[(size_t)fx].load(std::memory_order_acquire); }
+		static bool isDeferred(int fx) { return fx == 1 || fx == 6 || fx == 7; }
+
+		// the waveshaper and ring modulator are the only effects with latency
+		int getMaxLatencySamples() const
+		{
+			return waveshaper.getMaxLatencySamples() + ringmod.getLatencySamples();
+		}
+
+		// delays the lane's output, to line it up with a lane that has more latency
+		void compensate(juce::AudioSampleBuffer& buffer, int delaySamples)
+		{
+			latencyCompensation.process(buffer, delaySamples);
+		}
+
+		GainProcessor effectGain;
+		WaveShaperProcessor waveshaper;
+		gin::Dynamics compressor;
+		StereoDelayProcessor stereoDelay;
+		ChorusProcessor chorus;
+		PlateReverb<float, uint32_t> reverb;
+		MBFilterProcessor mbfilter;
+		RingModulator ringmod;
+		std::array<EffectIdleTracker, numEffectTypes> effectIdle; // skips an effect once its tail has died away
+		LatencyCompensation latencyCompensation;
+		std::array<std::atomic<bool>, numEffectTypes> ready{};
+		juce::dsp::ProcessSpec laneSpec{};
+	};
+	std::array<FXLane, 2> fxLanes; // A, B
+	LatencyCompensation auxLatencyCompensation; // for the aux synth when it's mixed in after the FX
 	juce::dsp::Limiter<float> limiter;
 
     gin::GainProcessor outputGain;
@@ -342,6 +484,7 @@ public:
 	SmoothedValue<float, ValueSmoothingTypes::Multiplicative> laneAFilterCutoff, laneBFilterCutoff;
 
 	gin::LevelTracker levelTracker;
+    RealtimeWorkerPool voicePool; // declared before the synths, so it outlives their voices
     APSynth synth;
 	juce::AudioBuffer<float> sidechainBuffer;
 	juce::AudioBuffer<float> sidechainSlice;
@@ -349,9 +492,19 @@ public:
 	juce::AudioBuffer<float> auxSlice;
 	juce::AudioBuffer<float> samplerBuffer;
 	juce::AudioBuffer<float> samplerSlice;
+	juce::AudioBuffer<float> fxBLaneBuffer; // lane B's copy of the input when the lanes run in parallel
 
 	MTSClient* client;
-	String scaleName, learningLabel;
+
+	std::atomic<int> controlBlockSize{ AP_CONTROL_BLOCK_SIZE };
+	std::atomic<bool> adaptiveControlBlocks{ false };
+	std::atomic<bool> parallelFXLanes{ false };
+	std::atomic<float> voiceSilenceGain{ juce::Decibels::decibelsToGain(AP_VOICE_SILENCE_DB) };
+	std::atomic<float> voiceSilenceMs{ AP_VOICE_SILENCE_MS };
+	int adaptiveBlockSize{ AP_CONTROL_BLOCK_SIZE };
+	bool subBlockEndsAtNote{ false };
+	std::array<float, 8> lastMonoModValues{};
+	static constexpr float adaptiveModThreshold = 0.02f; // mono modulation change that ends a long run
 
 
 	AuxSynth auxSynth;
@@ -362,6 +515,22 @@ public:
 	juce::AudioFormatManager formatManager;
 	juce::AudioFormatReader* reader{ nullptr };
 
+	// the effects' latency depends on their settings and the FX order, so it's
+	// checked from the message thread and passed on to the host when it changes
+	// listens to the parameters the latency depends on (the oversampling, the FX slots and
+	// the lane routing) and reports the new latency from the message thread
+	struct LatencyUpdater : public juce::AsyncUpdater, public gin::Parameter::ParameterListener
+	{
+		LatencyUpdater(APAudioProcessor& p) : proc(p) {}
+		void valueUpdated(gin::Parameter*) override { triggerAsyncUpdate(); }
+		void handleAsyncUpdate() override { proc.prepareLaneEffects(); proc.updateLatency(); }
+		APAudioProcessor& proc;
+	};
+	LatencyUpdater latencyUpdater{ *this };
+	std::atomic<double> tailSeconds{ 0.0 }; // from updateTailLength, for hosts on other threads
+	std::vector<gin::Parameter*> latencyParams() const;
+	juce::CriticalSection lanePrepareLock; // between prepareToPlay and prepareLaneEffects, never the audio thread
+
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (APAudioProcessor)
 };
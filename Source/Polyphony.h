@@ -0,0 +1,24 @@
+/*
+ * Audible Planets - an expressive, quasi-Ptolemaic semi-modular synthesizer
+ *
+ * Copyright 2024, Greg Recco
+ *
+ * Audible Planets is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * All source for Audible Planets is available at
+ * https://github.com/gregrecco67/AudiblePlanets
+ */
+
+#pragma once
+
+// each synth constructs this many voices up front, when the processor is created,
+// since the mod matrix needs all of its voices before it's built; the voices
+// parameter (2-8) times the voice multiplier (x1-x8) chooses how many can play at once
+#ifndef AP_MAX_VOICES
+ #define AP_MAX_VOICES 64
+#endif
+
+static_assert(AP_MAX_VOICES >= 2, "need at least two voices");
@@ -1,10 +1,30 @@
+#pragma once
+
 #include <JuceHeader.h>
 #include "FastMath.hpp"
+#include "ControlBlock.h"
 #include <numbers>
 
 using std::numbers::pi;
 using std::numbers::inv_pi;
 
+// render the four sub-voices of a QuadOscillator in one SIMD register; set to 0
+// to use the scalar path, which is kept as the reference implementation
+#ifndef AP_SIMD_OSCILLATOR
+ #if JUCE_USE_SIMD
+  #define AP_SIMD_OSCILLATOR 1
+ #else
+  #define AP_SIMD_OSCILLATOR 0
+ #endif
+#endif
+
+// build the 2nd-6th partials from one sin/cos pair per sub-voice with the
+// Chebyshev recurrence instead of a minimaxSin per partial; set to 0 to
+// evaluate every partial directly, as sineValueForPhaseAndTones does
+#ifndef AP_HARMONIC_RECURRENCE
+ #define AP_HARMONIC_RECURRENCE 1
+#endif
+
 struct Matrix {
 	friend Matrix operator*(const Matrix& m, const float s) { // scalar multiplication
 		return { m.a * s, m.b * s, m.c * s, m.d * s };
@@ -39,6 +59,13 @@ struct StereoPosition {
 	}
 };
 
+// a block of positions stored as one array per coordinate (structure of arrays),
+// so the per-sample stages of the orbital engine run over contiguous floats
+struct StereoPositionBlock {
+	static constexpr int maxSamples = AP_MAX_CONTROL_BLOCK_SIZE;
+	float xL[maxSamples]{}, yL[maxSamples]{}, xR[maxSamples]{}, yR[maxSamples]{};
+};
+
 
 enum class Wavetype
 {
@@ -154,34 +181,187 @@ public:
 		}
 	}
 
-	void renderPositions(const float freq_, const Params params_, StereoPosition positions[], const int numSamples) {
+	// picks the kernel for this block's wave type, so the sample loops don't test it
+	void renderPositions(const float freq_, const Params params_, StereoPositionBlock& positions, const int numSamples) {
+#if AP_SIMD_OSCILLATOR
+		if (params_.wave == Wavetype::sine)
+			renderPositionsSIMD<Wavetype::sine>(freq_, params_, positions, numSamples);
+		else
+			renderPositionsSIMD<Wavetype::sawUp>(freq_, params_, positions, numSamples);
+#else
+		if (params_.wave == Wavetype::sine)
+			renderPositionsScalar<Wavetype::sine>(freq_, params_, positions, numSamples);
+		else
+			renderPositionsScalar<Wavetype::sawUp>(freq_, params_, positions, numSamples);
+#endif
+	}
+
+	template <Wavetype wave>
+	void renderPositionsScalar(const float freq_, const Params params_, StereoPositionBlock& positions, const int numSamples) {
+		jassert(numSamples <= StereoPositionBlock::maxSamples);
 		freq = freq_;
 		params = params_;
 		recalculate();
+#if AP_HARMONIC_RECURRENCE
+		float weights[6], xWeights[6];
+		int numPartials = 0;
+		if constexpr (wave == Wavetype::sine) {
+			numPartials = toneWeights(params.tones, weights);
+			quarterTurnWeights(weights, xWeights);
+		}
+#endif
 		for (int i = 0; i < numSamples; i++) {
-			positions[i] = { 0.f, 0.f, 0.f, 0.f };
-			if (params.wave == Wavetype::sine) {
+			float xL{ 0.f }, yL{ 0.f }, xR{ 0.f }, yR{ 0.f };
+			if constexpr (wave == Wavetype::sine) {
 				for (int v = 0; v < 4; v++) {
-					positions[i].xL += (gainsL[v] * sineValueForPhaseAndTones(phases[v] + (params.phaseShift + 0.5f) * (float)pi, params.tones)) * .25f;
-					positions[i].yL += (gainsL[v] * sineValueForPhaseAndTones(phases[v] + params.phaseShift * (float)pi, params.tones)) * .25f;
-					positions[i].xR += (gainsR[v] * sineValueForPhaseAndTones(phases[v] + (params.phaseShift + 0.5f) * (float)pi, params.tones)) * .25f;
-					positions[i].yR += (gainsR[v] * sineValueForPhaseAndTones(phases[v] + params.phaseShift * (float)pi, params.tones)) * .25f;
+#if AP_HARMONIC_RECURRENCE
+					float x, y;
+					harmonicPair(phases[v] + params.phaseShift * (float)pi, weights, xWeights, numPartials, x, y);
+					xL += (gainsL[v] * x) * .25f;
+					yL += (gainsL[v] * y) * .25f;
+					xR += (gainsR[v] * x) * .25f;
+					yR += (gainsR[v] * y) * .25f;
+#else
+					xL += (gainsL[v] * sineValueForPhaseAndTones(phases[v] + (params.phaseShift + 0.5f) * (float)pi, params.tones)) * .25f;
+					yL += (gainsL[v] * sineValueForPhaseAndTones(phases[v] + params.phaseShift * (float)pi, params.tones)) * .25f;
+					xR += (gainsR[v] * sineValueForPhaseAndTones(phases[v] + (params.phaseShift + 0.5f) * (float)pi, params.tones)) * .25f;
+					yR += (gainsR[v] * sineValueForPhaseAndTones(phases[v] + params.phaseShift * (float)pi, params.tones)) * .25f;
+#endif
 					phases[v] += phaseIncs[v];
 					if (phases[v] > pi) { phases[v] -= 2.f * (float)pi; }
 				}
 			}
-			if (params.wave == Wavetype::sawUp) {
+			if constexpr (wave == Wavetype::sawUp) {
 				for (int v = 0; v < 4; v++) {
 					float quarterPhase = phases[v] + 0.25f * (float)pi;
 					if (quarterPhase > pi) { quarterPhase -= 2.f * (float)pi; }
-					positions[i].xL += (gainsL[v] * (quarterPhase * (float)inv_pi)) * .25f;
-					positions[i].yL += (gainsL[v] * (phases[v]    * (float)inv_pi)) * .25f;
-					positions[i].xR += (gainsR[v] * (quarterPhase * (float)inv_pi)) * .25f;
-					positions[i].yR += (gainsR[v] * (phases[v]    * (float)inv_pi)) * .25f;
+					xL += (gainsL[v] * (quarterPhase * (float)inv_pi)) * .25f;
+					yL += (gainsL[v] * (phases[v]    * (float)inv_pi)) * .25f;
+					xR += (gainsR[v] * (quarterPhase * (float)inv_pi)) * .25f;
+					yR += (gainsR[v] * (phases[v]    * (float)inv_pi)) * .25f;
 					phases[v] += phaseIncs[v];
 					if (phases[v] > pi) { phases[v] -= 2.f * (float)pi; }
 				}
 			}
+			positions.xL[i] = xL;
+			positions.yL[i] = yL;
+			positions.xR[i] = xR;
+			positions.yR[i] = yR;
+		}
+	}
+
+#if JUCE_USE_SIMD
+	// all four sub-voices side by side in one register: same phase accumulation
+	// and wrap as the scalar path, with the harmonic sum done per register
+	template <Wavetype wave>
+	void renderPositionsSIMD(const float freq_, const Params params_, StereoPositionBlock& positions, const int numSamples) {
+		using Reg = juce::dsp::SIMDRegister<float>;
+		static_assert(Reg::SIMDNumElements == 4, "one lane per sub-voice");
+		jassert(numSamples <= StereoPositionBlock::maxSamples);
+		freq = freq_;
+		params = params_;
+		recalculate();
+
+		Reg phaseReg = load(phases), incReg = load(phaseIncs);
+		const Reg gainL = load(gainsL) * .25f, gainR = load(gainsR) * .25f;
+		const Reg piReg((float)pi), twoPiReg(2.f * (float)pi);
+
+		if constexpr (wave == Wavetype::sine) {
+			float weights[6];
+			const int numPartials = toneWeights(params.tones, weights);
+#if AP_HARMONIC_RECURRENCE
+			float xWeights[6];
+			quarterTurnWeights(weights, xWeights);
+			const Reg yShift(params.phaseShift * (float)pi);
+#else
+			const Reg xShift((params.phaseShift + 0.5f) * (float)pi), yShift(params.phaseShift * (float)pi);
+#endif
+			for (int i = 0; i < numSamples; i++) {
+#if AP_HARMONIC_RECURRENCE
+				Reg x, y;
+				harmonicPair(phaseReg + yShift, weights, xWeights, numPartials, x, y);
+#else
+				Reg x = harmonicSum(phaseReg + xShift, weights, numPartials);
+				Reg y = harmonicSum(phaseReg + yShift, weights, numPartials);
+#endif
+				positions.xL[i] = (gainL * x).sum();
+				positions.yL[i] = (gainL * y).sum();
+				positions.xR[i] = (gainR * x).sum();
+				positions.yR[i] = (gainR * y).sum();
+				phaseReg += incReg;
+				phaseReg -= twoPiReg & Reg::greaterThan(phaseReg, piReg);
+			}
+		}
+		if constexpr (wave == Wavetype::sawUp) {
+			const Reg quarterPi(0.25f * (float)pi), invPi((float)inv_pi);
+			for (int i = 0; i < numSamples; i++) {
+				Reg quarterPhase = phaseReg + quarterPi;
+				quarterPhase -= twoPiReg & Reg::greaterThan(quarterPhase, piReg);
+				Reg x = quarterPhase * invPi, y = phaseReg * invPi;
+				positions.xL[i] = (gainL * x).sum();
+				positions.yL[i] = (gainL * y).sum();
+				positions.xR[i] = (gainR * x).sum();
+				positions.yR[i] = (gainR * y).sum();
+				phaseReg += incReg;
+				phaseReg -= twoPiReg & Reg::greaterThan(phaseReg, piReg);
+			}
+		}
+
+		for (int v = 0; v < 4; v++)
+			phases[v] = phaseReg.get((size_t)v);
+	}
+#endif
+
+	// level of each partial for a given tones value, as in sineValueForPhaseAndTones;
+	// returns how many partials are audible
+	static int toneWeights(float tones, float weights[6]) {
+		float fullTones{ 0.f };
+		float partialToneFraction = std::clamp(std::modf(tones, &fullTones), 0.0f, 1.0f);
+		static constexpr float levels[6] = { 1.0f, 0.5f, 0.33f, 0.25f, 0.2f, 0.16f };
+		int numPartials = 1;
+		weights[0] = 1.0f;
+		for (int h = 1; h < 6; h++) {
+			float lower = (float)h;
+			if (tones > lower && (tones < lower + 1.0f || h == 5))
+				weights[h] = partialToneFraction * levels[h];
+			else if (tones > lower)
+				weights[h] = levels[h];
+			else
+				weights[h] = 0.0f;
+			if (weights[h] != 0.0f)
+				numPartials = h + 1;
+		}
+		return numPartials;
+	}
+
+	// the x component runs a quarter turn ahead of y, and sin(n * (p + pi/2)) is
+	// cos(np), -sin(np), -cos(np), sin(np) for n = 1, 2, 3, 4 (mod 4), so the x
+	// partials are the y partials' sines and cosines with these signs
+	static void quarterTurnWeights(const float weights[6], float xWeights[6]) {
+		for (int h = 0; h < 6; h++) {
+			int n = (h + 1) % 4;
+			xWeights[h] = (n == 1 || n == 0) ? weights[h] : -weights[h];
+		}
+	}
+
+	// x and y values of one sub-voice, where phase_ is the phase of y: one sin/cos pair,
+	// then sin(n+1) = 2cos * sin(n) - sin(n-1) (and likewise for cos) for the upper partials
+	template <typename T>
+	static void harmonicPair(T phase_, const float weights[6], const float xWeights[6], int numPartials, T& x, T& y) {
+		T sinN = sineOf(phase_), cosN = sineOf(phase_ + T(0.5f * (float)pi));
+		T twoCos = cosN * T(2.0f);
+		T sinPrev(0.0f), cosPrev(1.0f);
+		x = cosN;
+		y = sinN;
+		for (int h = 1; h < numPartials; h++) {
+			T sinNext = twoCos * sinN - sinPrev;
+			T cosNext = twoCos * cosN - cosPrev;
+			sinPrev = sinN;
+			cosPrev = cosN;
+			sinN = sinNext;
+			cosN = cosNext;
+			y += sinN * T(weights[h]);
+			x += ((h & 1) ? sinN : cosN) * T(xWeights[h]); // odd h is an even partial
 		}
 	}
 
@@ -192,4 +372,25 @@ public:
 		}
 	}
 
+private:
+	static float sineOf(float phase_) { return FastMath<float>::minimaxSin(phase_); }
+
+#if JUCE_USE_SIMD
+	static juce::dsp::SIMDRegister<float> sineOf(juce::dsp::SIMDRegister<float> phase_) { return FastMath<float>::simdMinimaxSin(phase_); }
+
+	static juce::dsp::SIMDRegister<float> load(const float values[4]) {
+		juce::dsp::SIMDRegister<float> reg;
+		for (size_t v = 0; v < 4; v++)
+			reg.set(v, values[v]);
+		return reg;
+	}
+
+	static juce::dsp::SIMDRegister<float> harmonicSum(juce::dsp::SIMDRegister<float> phase_, const float weights[6], int numPartials) {
+		auto value = FastMath<float>::simdMinimaxSin(phase_);
+		for (int h = 1; h < numPartials; h++)
+			value += FastMath<float>::simdMinimaxSin(phase_ * (float)(h + 1)) * weights[h];
+		return value;
+	}
+#endif
+
 };
@@ -0,0 +1,212 @@
+/*
+ * Audible Planets - an expressive, quasi-Ptolemaic semi-modular synthesizer
+ *
+ * Copyright 2024, Greg Recco
+ *
+ * Audible Planets is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * All source for Audible Planets is available at
+ * https://github.com/gregrecco67/AudiblePlanets
+ */
+
+#include "RealtimeAudit.h"
+
+#if AP_REALTIME_AUDIT
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#if JUCE_LINUX
+ #include <dlfcn.h>
+ #include <pthread.h>
+#endif
+
+static std::atomic<int> numViolations{ 0 };
+
+void RealtimeAudit::reportViolation(const char* what)
+{
+	numViolations++;
+
+	// writing the report allocates, so this thread isn't audited while it does
+	const ScopedSuspend suspend;
+	const auto trace = juce::SystemStats::getStackBacktrace();
+	std::fprintf(stderr, "Real-time audit: %s on the audio thread\n%s\n", what, trace.toRawUTF8());
+	jassertfalse;
+}
+
+int RealtimeAudit::getNumViolations()
+{
+	return numViolations.load();
+}
+
+//==============================================================================
+#if JUCE_LINUX
+// Interposes malloc, calloc, realloc and free, so allocations from C code, from
+// libraries and from operator new (which comes down to malloc) are all seen. The
+// real functions are looked up with dlsym, which can itself calloc the first time;
+// those few allocations come from a small static arena and are never freed. The
+// aligned forms (aligned_alloc, posix_memalign, memalign) aren't interposed. As with
+// the mutex hook below, this only sees executables that link the plugin code in.
+namespace
+{
+	using MallocFunction = void* (*)(std::size_t);
+	using CallocFunction = void* (*)(std::size_t, std::size_t);
+	using ReallocFunction = void* (*)(void*, std::size_t);
+	using FreeFunction = void (*)(void*);
+
+	MallocFunction realMalloc = nullptr;
+	CallocFunction realCalloc = nullptr;
+	ReallocFunction realRealloc = nullptr;
+	FreeFunction realFree = nullptr;
+
+	enum { unresolved, resolving, resolved };
+	std::atomic<int> resolveState{ unresolved };
+
+	alignas(std::max_align_t) char bootstrapArena[4096]; // zeroed, so it serves calloc as well
+	std::atomic<std::size_t> bootstrapUsed{ 0 };
+
+	// false while the lookup is under way, on this thread or another
+	bool resolveAllocator()
+	{
+		if (resolveState.load(std::memory_order_acquire) == resolved)
+			return true;
+
+		int expected = unresolved;
+		if (!resolveState.compare_exchange_strong(expected, resolving))
+			return resolveState.load(std::memory_order_acquire) == resolved;
+
+		realMalloc = reinterpret_cast<MallocFunction>(dlsym(RTLD_NEXT, "malloc"));
+		realCalloc = reinterpret_cast<CallocFunction>(dlsym(RTLD_NEXT, "calloc"));
+		realRealloc = reinterpret_cast<ReallocFunction>(dlsym(RTLD_NEXT, "realloc"));
+		realFree = reinterpret_cast<FreeFunction>(dlsym(RTLD_NEXT, "free"));
+		resolveState.store(resolved, std::memory_order_release);
+		return true;
+	}
+
+	void* bootstrapAllocate(std::size_t size)
+	{
+		constexpr std::size_t alignment = alignof(std::max_align_t);
+		size = (size + alignment - 1) & ~(alignment - 1);
+		const auto offset = bootstrapUsed.fetch_add(size);
+		return offset + size <= sizeof(bootstrapArena) ? bootstrapArena + offset : nullptr;
+	}
+
+	bool isBootstrap(const void* p)
+	{
+		return p >= bootstrapArena && p < bootstrapArena + sizeof(bootstrapArena);
+	}
+}
+
+extern "C" void* malloc(std::size_t size)
+{
+	if (!resolveAllocator())
+		return bootstrapAllocate(size);
+	if (RealtimeAudit::isRealtimeThread)
+		RealtimeAudit::reportViolation("heap allocation");
+	return realMalloc(size);
+}
+
+extern "C" void* calloc(std::size_t count, std::size_t size)
+{
+	if (!resolveAllocator())
+		return size != 0 && count > sizeof(bootstrapArena) / size ? nullptr : bootstrapAllocate(count * size);
+	if (RealtimeAudit::isRealtimeThread)
+		RealtimeAudit::reportViolation("heap allocation");
+	return realCalloc(count, size);
+}
+
+extern "C" void* realloc(void* p, std::size_t size)
+{
+	if (!resolveAllocator())
+		return nullptr;
+	if (RealtimeAudit::isRealtimeThread)
+		RealtimeAudit::reportViolation("heap reallocation");
+
+	if (isBootstrap(p)) {
+		// the old size isn't kept, but the block can't run past the arena
+		void* moved = realMalloc(size);
+		if (moved != nullptr)
+			std::memcpy(moved, p, std::min(size, (std::size_t)(bootstrapArena + sizeof(bootstrapArena) - (char*)p)));
+		return moved;
+	}
+	return realRealloc(p, size);
+}
+
+extern "C" void free(void* p)
+{
+	if (p == nullptr || isBootstrap(p))
+		return;
+	if (RealtimeAudit::isRealtimeThread)
+		RealtimeAudit::reportViolation("heap deallocation");
+	if (resolveAllocator())
+		realFree(p);
+}
+
+#else
+// Elsewhere only C++ allocations are audited: these replace the global allocation
+// functions, and the nothrow, sized and array forms all end up here. The aligned
+// forms aren't replaced, and malloc from C code or from libraries isn't seen.
+static void* auditedAllocate(std::size_t size)
+{
+	if (RealtimeAudit::isRealtimeThread)
+		RealtimeAudit::reportViolation("heap allocation");
+
+	if (void* p = std::malloc(size == 0 ? 1 : size))
+		return p;
+	throw std::bad_alloc();
+}
+
+static void auditedFree(void* p) noexcept
+{
+	if (p != nullptr && RealtimeAudit::isRealtimeThread)
+		RealtimeAudit::reportViolation("heap deallocation");
+
+	std::free(p);
+}
+
+void* operator new(std::size_t size) { return auditedAllocate(size); }
+void* operator new[](std::size_t size) { return auditedAllocate(size); }
+void operator delete(void* p) noexcept { auditedFree(p); }
+void operator delete[](void* p) noexcept { auditedFree(p); }
+void operator delete(void* p, std::size_t) noexcept { auditedFree(p); }
+void operator delete[](void* p, std::size_t) noexcept { auditedFree(p); }
+#endif
+
+//==============================================================================
+#if JUCE_LINUX
+// Interposes pthread_mutex_lock, which CriticalSection, std::mutex and WaitableEvent
+// all come down to. Taking a free lock is only an atomic exchange, so just the locks
+// that would make the audio thread wait are reported. Symbols in a plugin loaded by a
+// host don't take precedence over libc's, so this only sees the Standalone build and
+// other executables that link the plugin code in.
+extern "C" int pthread_mutex_lock(pthread_mutex_t* mutex)
+{
+	using LockFunction = int (*)(pthread_mutex_t*);
+	// constant-initialized, so there's no guard around them, which could itself lock
+	static std::atomic<LockFunction> realLock{ nullptr }, realTryLock{ nullptr };
+
+	auto lock = realLock.load(std::memory_order_relaxed);
+	if (lock == nullptr) {
+		lock = reinterpret_cast<LockFunction>(dlsym(RTLD_NEXT, "pthread_mutex_lock"));
+		realTryLock = reinterpret_cast<LockFunction>(dlsym(RTLD_NEXT, "pthread_mutex_trylock"));
+		realLock = lock;
+	}
+
+	if (RealtimeAudit::isRealtimeThread) {
+		if (realTryLock.load()(mutex) == 0)
+			return 0;
+		RealtimeAudit::reportViolation("waiting on a mutex");
+	}
+
+	return lock(mutex);
+}
+#endif
+
+#endif
@@ -0,0 +1,59 @@
+/*
+ * Audible Planets - an expressive, quasi-Ptolemaic semi-modular synthesizer
+ *
+ * Copyright 2024, Greg Recco
+ *
+ * Audible Planets is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * All source for Audible Planets is available at
+ * https://github.com/gregrecco67/AudiblePlanets
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// In debug builds, or with the AP_REALTIME_AUDIT CMake option, the audio thread is
+// watched for heap allocation and for waiting on a mutex (see RealtimeAudit.cpp). Each
+// one is counted and reported to stderr with a stack trace, then asserts. On Linux
+// malloc and friends are hooked, so C and library allocations are caught too; on
+// other platforms only C++ allocations (operator new and delete) are. Threads mark
+// themselves as real-time for a scope with RealtimeAudit::ScopedRealtimeThread.
+#ifndef AP_REALTIME_AUDIT
+ #define AP_REALTIME_AUDIT JUCE_DEBUG
+#endif
+
+namespace RealtimeAudit
+{
+#if AP_REALTIME_AUDIT
+	inline thread_local bool isRealtimeThread = false;
+
+	struct ScopedRealtimeThread
+	{
+		ScopedRealtimeThread() : wasRealtime(isRealtimeThread) { isRealtimeThread = true; }
+		~ScopedRealtimeThread() { isRealtimeThread = wasRealtime; }
+		const bool wasRealtime;
+	};
+
+	// for work on the audio thread that's known to allocate or lock, and is allowed to
+	struct ScopedSuspend
+	{
+		ScopedSuspend() : wasRealtime(isRealtimeThread) { isRealtimeThread = false; }
+		~ScopedSuspend() { isRealtimeThread = wasRealtime; }
+		const bool wasRealtime;
+	};
+
+	void reportViolation(const char* what);
+
+	// violations so far, for tools that drive processBlock and check it stayed clean
+	int getNumViolations();
+#else
+	struct ScopedRealtimeThread {};
+	struct ScopedSuspend {};
+
+	inline int getNumViolations() { return 0; }
+#endif
+}
@@ -0,0 +1,87 @@
+/*
+ * Audible Planets - an expressive, quasi-Ptolemaic semi-modular synthesizer
+ *
+ * Copyright 2024, Greg Recco
+ *
+ * Audible Planets is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * All source for Audible Planets is available at
+ * https://github.com/gregrecco67/AudiblePlanets
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// a released voice whose output stays below the threshold for this long is ended
+// early, rather than rendering silence until its envelopes finish. The hold is in
+// milliseconds so it doesn't change with the sample rate or the control block size.
+#ifndef AP_VOICE_SILENCE_DB
+ #define AP_VOICE_SILENCE_DB -96.0f
+#endif
+
+#ifndef AP_VOICE_SILENCE_MS
+ #define AP_VOICE_SILENCE_MS 5.0f
+#endif
+
+// once it has been quiet for the hold time, the voice fades out over this long,
+// across as many sub-blocks as that takes, and then stops
+#ifndef AP_VOICE_SILENCE_FADE_MS
+ #define AP_VOICE_SILENCE_FADE_MS 2.0f
+#endif
+
+// Tracks how long a voice's output has been quiet once the note has been released.
+// When it's been quiet for long enough, the voice fades to zero and can stop.
+class SilenceDetector
+{
+public:
+	void noteStarted() { released = false; quietSamples = 0; fadeRemaining = 0; }
+	void noteReleased() { released = true; }
+
+	// call with the voice's finished output; true once the fade has finished, so stop the voice
+	bool process(juce::AudioBuffer<float>& buffer, int numSamples, float thresholdGain, float holdMs, double sampleRate)
+	{
+		if (!released || holdMs <= 0.f || sampleRate <= 0.0)
+			return false;
+
+		if (fadeRemaining == 0) {
+			// only the quiet samples at the end of the block carry over into the count
+			int lastLoud = -1;
+			for (int ch = 0; ch < buffer.getNumChannels(); ch++) {
+				const float* data = buffer.getReadPointer(ch);
+				for (int i = numSamples - 1; i > lastLoud; i--) {
+					if (std::abs(data[i]) >= thresholdGain) {
+						lastLoud = i;
+						break;
+					}
+				}
+			}
+			quietSamples = lastLoud < 0 ? quietSamples + numSamples : numSamples - 1 - lastLoud;
+
+			if (quietSamples < (int)std::ceil(holdMs * 0.001 * sampleRate))
+				return false;
+
+			fadeLength = fadeRemaining = std::max(1, (int)std::ceil(AP_VOICE_SILENCE_FADE_MS * 0.001 * sampleRate));
+		}
+
+		// carry on from where the last block's fade left off, then silence
+		const int n = std::min(numSamples, fadeRemaining);
+		const float startGain = (float)fadeRemaining / (float)fadeLength;
+		const float endGain = (float)(fadeRemaining - n) / (float)fadeLength;
+		for (int ch = 0; ch < buffer.getNumChannels(); ch++) {
+			buffer.applyGainRamp(ch, 0, n, startGain, endGain);
+			if (n < numSamples)
+				buffer.clear(ch, n, numSamples - n);
+		}
+		fadeRemaining -= n;
+		return fadeRemaining == 0;
+	}
+
+private:
+	bool released{ false };
+	int quietSamples{ 0 };
+	int fadeLength{ 1 }, fadeRemaining{ 0 }; // fadeRemaining > 0 while fading out
+};
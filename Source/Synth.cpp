@@ -6,14 +6,22 @@ APSynth::APSynth(APAudioProcessor& proc_) : proc(proc_)
     enableLegacyMode(12);
     setVoiceStealingEnabled(true);
 
-    for (int i = 0; i < 16; i++)
+    for (int i = 0; i < AP_MAX_VOICES; i++)
     {
         auto voice = new SynthVoice(proc);
         proc.modMatrix.addVoice(voice);
         addVoice(voice);
+        voiceRenderer.addVoice(voice);
     }
 }
 
+// voices render on the processor's worker pool when it has threads, otherwise serially
+void APSynth::renderNextSubBlock(juce::AudioBuffer<float>& outputAudio, int startSample, int numSamples)
+{
+    const juce::ScopedLock sl(voicesLock);
+    voiceRenderer.render(proc.voicePool, outputAudio, startSample, numSamples);
+}
+
 juce::Array<float> APSynth::getLiveFilterCutoff() {
     juce::Array<float> values;
     
@@ -87,6 +95,7 @@ std::vector<float> APSynth::getMSEG4Phases() {
 
 void APSynth::handleMidiEvent(const juce::MidiMessage& m) {
     MPESynthesiser::handleMidiEvent(m);
+    voiceRenderer.voicesMayHaveStarted();
 
 	if (m.isSysEx()) {
 		MTS_ParseMIDIDataU(proc.client, m.getSysExData(), m.getSysExDataSize());
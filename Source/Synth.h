@@ -2,6 +2,8 @@
 #include <JuceHeader.h>
 #include <gin/gin.h>
 #include "SynthVoice.h"
+#include "WorkerPool.h"
+#include "Polyphony.h"
 
 class APAudioProcessor;
 
@@ -19,7 +21,11 @@ public:
 	std::vector<float> getMSEG3Phases();
 	std::vector<float> getMSEG4Phases();
     
+protected:
+    void renderNextSubBlock(juce::AudioBuffer<float>& outputAudio, int startSample, int numSamples) override;
+
 private:
     APAudioProcessor& proc;
+    ActiveVoiceRenderer voiceRenderer;
     
 };
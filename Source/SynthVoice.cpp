@@ -82,6 +82,7 @@ void SynthVoice::noteStarted()
 	env2.noteOn();
 	env3.noteOn();
 	env4.noteOn();
+	silence.noteStarted();
 
 	mseg1.noteOn();
 	mseg2.noteOn();
@@ -120,6 +121,7 @@ void SynthVoice::noteRetriggered()
 	env2.noteOn();
 	env3.noteOn();
 	env4.noteOn();
+	silence.noteStarted();
 
 }
 
@@ -129,6 +131,7 @@ void SynthVoice::noteStopped(bool allowTailOff)
 	env2.noteOff();
 	env3.noteOff();
 	env4.noteOff();
+	silence.noteReleased();
     if (!allowTailOff) {
         clearCurrentNote();
         stopVoice();
@@ -183,8 +186,9 @@ void SynthVoice::setCurrentSampleRate(double newRate)
 
 void SynthVoice::renderNextBlock(juce::AudioBuffer<float>& outputBuffer, int startSample, int numSamples)
 {
+	jassert(numSamples <= maxBlockSize);
 	updateParams(numSamples);
-	gin::ScratchBuffer synthBuffer(2, numSamples);
+	synthBuffer.setSize(2, numSamples, false, false, true);
 
 	// we do this to advance phase, even if we have to overwrite with sidechain (rare)
 	osc1.renderPositions(osc1Freq, osc1Params, osc1Positions, numSamples); 
@@ -193,10 +197,10 @@ void SynthVoice::renderNextBlock(juce::AudioBuffer<float>& outputBuffer, int sta
 		// taking sidechain as the vertical component, we calculate the horizontal component
 		// effectively mapping the sidechain to a semicircle
 		for (int i = 0; i < numSamples; i++) {
-			osc1Positions[i].yL = std::clamp(proc.sidechainSlice.getSample(0, i), -1.f, 1.f);
-			osc1Positions[i].yR = std::clamp(proc.sidechainSlice.getSample(1, i), -1.f, 1.f);
-			osc1Positions[i].xL = std::sqrt(1.f - osc1Positions[i].yL * osc1Positions[i].yL) * 2.f - 1.f;
-			osc1Positions[i].xR = std::sqrt(1.f - osc1Positions[i].yR * osc1Positions[i].yR) * 2.f - 1.f;
+			osc1Positions.yL[i] = std::clamp(proc.sidechainSlice.getSample(0, i), -1.f, 1.f);
+			osc1Positions.yR[i] = std::clamp(proc.sidechainSlice.getSample(1, i), -1.f, 1.f);
+			osc1Positions.xL[i] = std::sqrt(1.f - osc1Positions.yL[i] * osc1Positions.yL[i]) * 2.f - 1.f;
+			osc1Positions.xR[i] = std::sqrt(1.f - osc1Positions.yR[i] * osc1Positions.yR[i]) * 2.f - 1.f;
 		}
 	}
 	
@@ -204,264 +208,33 @@ void SynthVoice::renderNextBlock(juce::AudioBuffer<float>& outputBuffer, int sta
 	osc3.renderPositions(osc3Freq, osc3Params, osc3Positions, numSamples);
 	osc4.renderPositions(osc4Freq, osc4Params, osc4Positions, numSamples);
 
-	// more squash = smaller k, which scales about the tangent to the deferent
-	float k = 1.f - getValue(proc.globalParams.squash); 
-    
-	// the whole enchilada
-	for (int i = 0; i < numSamples; i++)
-	{
-		env1.getNextSample(); // advance each envelope, we'll read them below as necessary
-        env2.getNextSample();
-        env3.getNextSample();
-        env4.getNextSample();
-        auto a = envs[0]->getOutput(); // read each envelope value from the pointer for each osc
-		auto b = envs[1]->getOutput(); // a = current output of envelope assigned to osc1, etc.
-        auto c = envs[2]->getOutput(); // 
-        auto d = envs[3]->getOutput();
-
-		// calculate squash matrix
-		// get distances in order to normalize vectors
-		float distanceL = std::sqrt(osc1Positions[i].xL * osc1Positions[i].xL + (osc1Positions[i].yL - equant) * (osc1Positions[i].yL - equant));
-		float distanceR = std::sqrt(osc1Positions[i].xR * osc1Positions[i].xR + (osc1Positions[i].yR - equant) * (osc1Positions[i].yR - equant));
-		// normalized vectors
-		float cosThetaL = (osc1Positions[i].yL - equant) /  (distanceL + .000001f); // what we want is the tangent to the orbit at this point
-		float sinThetaL = -osc1Positions[i].xL / (distanceL + .000001f); // so swap x and y and negate y
-		float cosThetaR = (osc1Positions[i].yR - equant) /  (distanceR + .000001f);
-		float sinThetaR = -osc1Positions[i].xR / (distanceR + .000001f); // +.001f to avoid divide by zero
-		float cos2ThetaL = cosThetaL * cosThetaL;
-		float cos2ThetaR = cosThetaR * cosThetaR;
-		float sin2ThetaL = sinThetaL * sinThetaL;
-		float sin2ThetaR = sinThetaR * sinThetaR;
-
-		// plug in to transform matrix
-		StereoMatrix squash1 = {
-			.left = {
-				.a = cos2ThetaL + k * sin2ThetaL, .b = cosThetaL * sinThetaL * (1.0f - k),
-				.c = cosThetaL * sinThetaL * (1.0f - k), .d = sin2ThetaL + k * cos2ThetaL
-			},
-			.right = {
-				.a = cos2ThetaR + k * sin2ThetaR, .b = cosThetaR * sinThetaR * (1.0f - k),
-				.c = cosThetaR * sinThetaR * (1.0f - k), .d = sin2ThetaR + k * cos2ThetaR
-			}
-		};
-
-		// separate matrix for each orbit that can be the basis for another
-		distanceL = std::sqrt(osc2Positions[i].xL * osc2Positions[i].xL + (osc2Positions[i].yL - equant) * (osc2Positions[i].yL - equant));
-		distanceR = std::sqrt(osc2Positions[i].xR * osc2Positions[i].xR + (osc2Positions[i].yR - equant) * (osc2Positions[i].yR - equant));
-		// normalized vectors
-		cosThetaL =  (osc2Positions[i].yL - equant) / (distanceL + .000001f); // what we want is the tangent to the orbit at this point
-		sinThetaL = -osc2Positions[i].xL / (distanceL + .000001f); // so swap x and y and negate y
-		cosThetaR =  (osc2Positions[i].yR - equant) / (distanceR + .000001f);
-		sinThetaR = -osc2Positions[i].xR / (distanceR + .000001f); // +.001f to avoid divide by zero
-		cos2ThetaL = cosThetaL * cosThetaL;
-		cos2ThetaR = cosThetaR * cosThetaR;
-		sin2ThetaL = sinThetaL * sinThetaL;
-		sin2ThetaR = sinThetaR * sinThetaR;
-		
-		//if (i == 0)
-		//	DBG(String(sin2ThetaL + cos2ThetaL));
-
-		StereoMatrix squash2 = {
-			.left = {
-				.a = cos2ThetaL + k * sin2ThetaL, .b = cosThetaL * sinThetaL * (1.0f - k),
-				.c = cosThetaL * sinThetaL * (1.0f - k), .d = sin2ThetaL + k * cos2ThetaL
-			},
-			.right = {
-				.a = cos2ThetaR + k * sin2ThetaR, .b = cosThetaR * sinThetaR * (1.0f - k),
-				.c = cosThetaR * sinThetaR * (1.0f - k), .d = sin2ThetaR + k * cos2ThetaR
-			}
-		};
-
-		// separate matrix for each orbit that can be the basis for another
-		distanceL = std::sqrt(osc3Positions[i].xL * osc3Positions[i].xL + (osc3Positions[i].yL - equant) * (osc3Positions[i].yL - equant));
-		distanceR = std::sqrt(osc3Positions[i].xR * osc3Positions[i].xR + (osc3Positions[i].yR - equant) * (osc3Positions[i].yR - equant));
-		// normalized vectors
-		cosThetaL =  (osc3Positions[i].yL - equant) / (distanceL + .000001f); // what we want is the tangent to the orbit at this point
-		sinThetaL = -osc3Positions[i].xL / (distanceL + .000001f); // so swap x and y and negate y
-		cosThetaR =  (osc3Positions[i].yR - equant) / (distanceR + .000001f);
-		sinThetaR = -osc3Positions[i].xR / (distanceR + .000001f); // +.001f to avoid divide by zero
-		cos2ThetaL = cosThetaL * cosThetaL;
-		cos2ThetaR = cosThetaR * cosThetaR;
-		sin2ThetaL = sinThetaL * sinThetaL;
-		sin2ThetaR = sinThetaR * sinThetaR;
-
-		StereoMatrix squash3 = {
-			.left = {
-				.a = cos2ThetaL + k * sin2ThetaL, .b = cosThetaL * sinThetaL * (1.0f - k),
-				.c = cosThetaL * sinThetaL * (1.0f - k), .d = sin2ThetaL + k * cos2ThetaL
-			},
-			.right = {
-				.a = cos2ThetaR + k * sin2ThetaR, .b = cosThetaR * sinThetaR * (1.0f - k),
-				.c = cosThetaR * sinThetaR * (1.0f - k), .d = sin2ThetaR + k * cos2ThetaR
-			}
-		};
-
-
-		epi1 = osc1Positions[i] * (a * osc1Vol); // position of body on first circle, scaled by osc1 selected envelope
-		
-		// apply the squash matrix to squash secondary orbits along the tangent of the one they're orbiting
-		epi2 = epi1 + ((osc2Positions[i] * squash1) * (b * osc2Vol)); 
-		
-		// get bodies 3 & 4 position by algorithm
-		if (algo == 0) // 1-2-3-(4)
-		{
-			epi3 = epi2 + ((osc3Positions[i] * squash2) * (c * osc3Vol));
-			epi4 = epi3 + ((osc4Positions[i] * squash3) * (d * osc4Vol));
-		}
-		if (algo == 1) { // 1-2-(3), 2-(4)
-			epi3 = epi2 + ((osc3Positions[i] * squash2) * (c * osc3Vol));
-			epi4 = epi2 + ((osc4Positions[i] * squash2) * (d * osc4Vol));
-		}
-		if (algo == 2) { // 1-(2), 1-3-(4)
-			epi3 = epi1 + ((osc3Positions[i] * squash1) * (c * osc3Vol));
-			epi4 = epi3 + ((osc4Positions[i] * squash3) * (d * osc4Vol));
-		}
-		if (algo == 3) { // 1-(2), 1-(3), 1-(4)
-			epi3 = epi1 + ((osc3Positions[i] * squash1) * (c * osc3Vol));
-			epi4 = epi1 + ((osc4Positions[i] * squash1) * (d * osc4Vol));
-		}
-
-
-		// ----------------------------------------
-		// interpret bodies' positions by algorithm
-		// ----------------------------------------
-		
-		// 1. get angles
-        float atanAngle2L{0}, atanAngle2R{0}, atanAngle3L{0}, atanAngle3R{0}, atanAngle4L, atanAngle4R;
-
-		atanAngle4L = FastMath<float>::fastAtan2(epi4.yL - equant, epi4.xL);
-		atanAngle4R = FastMath<float>::fastAtan2(epi4.yR - equant, epi4.xR);
-		if (algo == 1)
-		{
-			atanAngle3L = FastMath<float>::fastAtan2(epi3.yL - equant, epi3.xL);
-			atanAngle3R = FastMath<float>::fastAtan2(epi3.yR - equant, epi3.xR);
-		}
-		if (algo == 2) {
-			atanAngle2L = FastMath<float>::fastAtan2(epi2.yL - equant, epi2.xL);
-			atanAngle2R = FastMath<float>::fastAtan2(epi2.yR - equant, epi2.xR);
-		}
-		if (algo == 3) {
-			atanAngle2L = FastMath<float>::fastAtan2(epi2.yL - equant, epi2.xL);
-			atanAngle2R = FastMath<float>::fastAtan2(epi2.yR - equant, epi2.xR);
-			atanAngle3L = FastMath<float>::fastAtan2(epi3.yL - equant, epi3.xL);
-			atanAngle3R = FastMath<float>::fastAtan2(epi3.yR - equant, epi3.xR);
-		}
-
-		// 2. generate component waveforms from angles
-		float sine2L{ 0.f }, sine2R{ 0.f }, sine3L{ 0.f }, sine3R{ 0.f }, sine4L{ 0.f }, sine4R{ 0.f };
-		float square2L{ 0.f }, square2R{ 0.f }, square3L{ 0.f }, square3R{ 0.f }, square4L{ 0.f }, square4R{ 0.f };
-		float saw2L{ 0.f }, saw2R{ 0.f }, saw3L{ 0.f }, saw3R{ 0.f }, saw4L{ 0.f }, saw4R{ 0.f };
-
-		sine4L = FastMath<float>::minimaxSin(atanAngle4L);
-		sine4R = FastMath<float>::minimaxSin(atanAngle4R);
-		square4L = (atanAngle4L > 0.f) ? 1.0f : -1.0f;
-		square4R = (atanAngle4R > 0.f) ? 1.0f : -1.0f;
-		saw4L = (atanAngle4L * (float)inv_pi) * 2.0f - 1.0f;
-		saw4R = (atanAngle4R * (float)inv_pi) * 2.0f - 1.0f;
-		if (algo == 1) {
-			sine3L = FastMath<float>::minimaxSin(atanAngle3L);
-			sine3R = FastMath<float>::minimaxSin(atanAngle3R);
-			square3L = (atanAngle3L > 0.f) ? 1.0f : -1.0f;
-			square3R = (atanAngle3R > 0.f) ? 1.0f : -1.0f;
-			saw3L = (atanAngle3L * (float)inv_pi) * 2.0f - 1.0f;
-			saw3R = (atanAngle3R * (float)inv_pi) * 2.0f - 1.0f;
-		}
-		if (algo == 2) {
-			sine2L = FastMath<float>::minimaxSin(atanAngle2L);
-			sine2R = FastMath<float>::minimaxSin(atanAngle2R);
-			square2L = (atanAngle2L > 0.f) ? 1.0f : -1.0f;
-			square2R = (atanAngle2R > 0.f) ? 1.0f : -1.0f;
-			saw2L = (atanAngle2L * (float)inv_pi) * 2.0f - 1.0f;
-			saw2R = (atanAngle2R * (float)inv_pi) * 2.0f - 1.0f;
-		}
-		if (algo == 3) {
-			sine2L = FastMath<float>::minimaxSin(atanAngle2L);
-			sine2R = FastMath<float>::minimaxSin(atanAngle2R);
-			square2L = (atanAngle2L > 0.f) ? 1.0f : -1.0f;
-			square2R = (atanAngle2R > 0.f) ? 1.0f : -1.0f;
-			saw2L = (atanAngle2L * (float)inv_pi) * 2.0f - 1.0f;
-			saw2R = (atanAngle2R * (float)inv_pi) * 2.0f - 1.0f;
-			sine3L = FastMath<float>::minimaxSin(atanAngle3L);
-			sine3R = FastMath<float>::minimaxSin(atanAngle3R);
-			square3L = (atanAngle3L > 0.f) ? 1.0f : -1.0f;
-			square3R = (atanAngle3R > 0.f) ? 1.0f : -1.0f;
-			saw3L = (atanAngle3L * (float)inv_pi) * 2.0f - 1.0f;
-			saw3R = (atanAngle3R * (float)inv_pi) * 2.0f - 1.0f;
-		}
-
-		// 3. mix component waveforms by blend value
-		float sample2L, sample2R, sample3L, sample3R, sample4L, sample4R;
-		auto blend = getValue(proc.timbreParams.blend);
-		if (blend < 0.5f)
-		{
-			sample2L = (sine2L * (1.f - blend * 2.0f) + square2L * blend * 2.0f);
-			sample2R = (sine2R * (1.f - blend * 2.0f) + square2R * blend * 2.0f);
-			sample3L = (sine3L * (1.f - blend * 2.0f) + square3L * blend * 2.0f);
-			sample3R = (sine3R * (1.f - blend * 2.0f) + square3R * blend * 2.0f);
-			sample4L = (sine4L * (1.f - blend * 2.0f) + square4L * blend * 2.0f);
-			sample4R = (sine4R * (1.f - blend * 2.0f) + square4R * blend * 2.0f);
-		}
-		else {
-			sample2L = (square2L * (1.0f - blend) * 2.0f + saw2L * (blend - 0.5f) * 2.f);
-			sample2R = (square2R * (1.0f - blend) * 2.0f + saw2R * (blend - 0.5f) * 2.f);
-			sample3L = (square3L * (1.0f - blend) * 2.0f + saw3L * (blend - 0.5f) * 2.f);
-			sample3R = (square3R * (1.0f - blend) * 2.0f + saw3R * (blend - 0.5f) * 2.f);
-			sample4L = (square4L * (1.0f - blend) * 2.0f + saw4L * (blend - 0.5f) * 2.f);
-			sample4R = (square4R * (1.0f - blend) * 2.0f + saw4R * (blend - 0.5f) * 2.f);
-		}
-
-		// 4. compute modulated and demodulated samples, and mix them by demodmix
-		float modSample2L{ sample2L }, demodSample2L{ sample2L }, modSample2R{ sample2R }, demodSample2R{ sample2R };
-		float modSample3L{ sample3L }, demodSample3L{ sample3L }, modSample3R{ sample3R }, demodSample3R{ sample3R };
-		float modSample4L{ sample4L }, demodSample4L{ sample4L }, modSample4R{ sample4R }, demodSample4R{ sample4R };
-
-		// 5. demodulate by considering not just angle, but also magnitude of planet vector
-		auto atanDistance2L = (float)std::sqrt(epi2.xL * epi2.xL + (epi2.yL - equant) * (epi2.yL - equant));
-		auto atanDistance2R = (float)std::sqrt(epi2.xR * epi2.xR + (epi2.yR - equant) * (epi2.yR - equant));
-		auto atanDistance3L = (float)std::sqrt(epi3.xL * epi3.xL + (epi3.yL - equant) * (epi3.yL - equant));
-		auto atanDistance3R = (float)std::sqrt(epi3.xR * epi3.xR + (epi3.yR - equant) * (epi3.yR - equant));
-		auto atanDistance4L = (float)std::sqrt(epi4.xL * epi4.xL + (epi4.yL - equant) * (epi4.yL - equant));
-		auto atanDistance4R = (float)std::sqrt(epi4.xR * epi4.xR + (epi4.yR - equant) * (epi4.yR - equant));
-
-		demodSample2L *= (atanDistance2L * demodVol); // adjustable balancing term
-		demodSample2R *= (atanDistance2R * demodVol);
-		demodSample3L *= (atanDistance3L * demodVol);
-		demodSample3R *= (atanDistance3R * demodVol);
-		demodSample4L *= (atanDistance4L * demodVol);
-		demodSample4R *= (atanDistance4R * demodVol);
-
-		// since mod samples are angle-only, we need to reapply their envelope values
-		modSample2L *= envs[1]->getOutput();
-		modSample2R *= envs[1]->getOutput();
-		modSample3L *= envs[2]->getOutput();
-		modSample3R *= envs[2]->getOutput();
-		modSample4L *= envs[3]->getOutput();
-		modSample4R *= envs[3]->getOutput();
-
-		// 6. mix by demodmix AND ALGO
-		float sampleL{ 0.f }, sampleR{ 0.f };
-		auto demodmix = getValue(proc.timbreParams.demodmix);
-		if (algo == 0) {
-			sampleL = (modSample4L * (1.0f - demodmix) + demodSample4L * demodmix);
-			sampleR = (modSample4R * (1.0f - demodmix) + demodSample4R * demodmix);
-		}
-		if (algo == 1) {
-			sampleL = ((modSample3L + modSample4L) * 0.5f * (1.0f - demodmix) + (demodSample3L + demodSample4L) * 0.5f * demodmix);
-			sampleR = ((modSample3R + modSample4R) * 0.5f * (1.0f - demodmix) + (demodSample3R + demodSample4R) * 0.5f * demodmix);
-		}
-		if (algo == 2) {
-			sampleL = ((modSample2L + modSample4L) * 0.5f * (1.0f - demodmix) + (demodSample2L + demodSample4L) * 0.5f * demodmix);
-			sampleR = ((modSample2R + modSample4R) * 0.5f * (1.0f - demodmix) + (demodSample2R + demodSample4R) * 0.5f * demodmix);
-		}
-		if (algo == 3) {
-			sampleL = ((modSample2L + modSample3L + modSample4L) * 0.333f * (1.0f - demodmix) + (demodSample2L + demodSample3L + demodSample4L) * 0.333f * demodmix);
-			sampleR = ((modSample2R + modSample3R + modSample4R) * 0.333f * (1.0f - demodmix) + (demodSample2R + demodSample3L + demodSample4R) * 0.333f * demodmix);
-		}
-
-		// 7. SHIP IT OUT
-		synthBuffer.setSample(0, i, sampleL);
-		synthBuffer.setSample(1, i, sampleR);
-	}
+	// demodVol, demodmix and squash ramp from the previous block's values when
+	// AP_TIMBRE_RAMPS is set; blend steps, since it selects the render kernel
+	orbitInputs.squashK.set(previousTimbre.squashK, timbre.squashK, numSamples, AP_TIMBRE_RAMPS);
+	orbitInputs.demodVol.set(previousTimbre.demodVol, timbre.demodVol, numSamples, AP_TIMBRE_RAMPS);
+	orbitInputs.demodmix.set(previousTimbre.demodmix, timbre.demodmix, numSamples, AP_TIMBRE_RAMPS);
+	orbitInputs.equant = timbre.equant;
+	orbitInputs.blend = timbre.blend;
+	orbitInputs.vol[0] = osc1Vol;
+	orbitInputs.vol[1] = osc2Vol;
+	orbitInputs.vol[2] = osc3Vol;
+	orbitInputs.vol[3] = osc4Vol;
+
+	// the whole enchilada, one stage at a time over the block
+
+	// 1. render each envelope, then point each osc at the one assigned to it
+	env1.renderBlock(envOutputs[0], numSamples);
+	env2.renderBlock(envOutputs[1], numSamples);
+	env3.renderBlock(envOutputs[2], numSamples);
+	env4.renderBlock(envOutputs[3], numSamples);
+	for (int k = 0; k < 4; k++)
+		for (int j = 0; j < 4; j++)
+			if (envs[k] == allEnvs[j])
+				orbitInputs.env[k] = envOutputs[j];
+
+	// 2.-5. squash, bodies, waveforms and mix, in one kernel per algorithm and blend range
+	if (!OrbitEngine::render(timbre.algo, orbitInputs, orbits, synthBuffer.getWritePointer(0), synthBuffer.getWritePointer(1), numSamples))
+		synthBuffer.clear();
 
 	// Get and apply velocity according to keytrack param
 	float velocity = currentlyPlayingNote.noteOnVelocity.asUnsignedFloat();
@@ -472,7 +245,7 @@ void SynthVoice::renderNextBlock(juce::AudioBuffer<float>& outputBuffer, int sta
 		filter.process(synthBuffer);
 
     bool voiceShouldStop = false;
-	switch(algo) {
+	switch(timbre.algo) {
 	case 0:
 		if (!envs[3]->isActive()) // 1-2-3-(4)
 			voiceShouldStop = true;
@@ -490,6 +263,8 @@ void SynthVoice::renderNextBlock(juce::AudioBuffer<float>& outputBuffer, int sta
 			voiceShouldStop = true;
 		break;
 	}
+	if (silence.process(synthBuffer, numSamples, proc.getVoiceSilenceThreshold(), proc.getVoiceSilenceMs(), getSampleRate()))
+		voiceShouldStop = true;
     if (voiceShouldStop)
 	{
 		clearCurrentNote();
@@ -505,9 +280,10 @@ void SynthVoice::renderNextBlock(juce::AudioBuffer<float>& outputBuffer, int sta
 
 void SynthVoice::updateParams(int blockSize)
 {
-	algo = (int)getValue(proc.timbreParams.algo);
-	equant = getValue(proc.timbreParams.equant);
-	demodVol = getValue(proc.timbreParams.demodVol);
+	previousTimbre = timbre;
+	timbre.algo = (int)getValue(proc.timbreParams.algo);
+	timbre.equant = getValue(proc.timbreParams.equant);
+	timbre.demodVol = getValue(proc.timbreParams.demodVol);
 
 	auto note = getCurrentlyPlayingNote();
 
@@ -893,6 +669,14 @@ void SynthVoice::updateParams(int blockSize)
 	proc.modMatrix.setPolyValue(*this, proc.modSrcMSEG2, mseg2.getOutput());
 	proc.modMatrix.setPolyValue(*this, proc.modSrcMSEG3, mseg3.getOutput());
 	proc.modMatrix.setPolyValue(*this, proc.modSrcMSEG4, mseg4.getOutput());
+
+	// these see this block's envelopes, LFOs and MSEGs
+	// more squash = smaller k, which scales about the tangent to the deferent
+	timbre.squashK = 1.f - getValue(proc.globalParams.squash);
+	timbre.blend = getValue(proc.timbreParams.blend);
+	timbre.demodmix = getValue(proc.timbreParams.demodmix);
+	if (blockSize == 0) // note start: nothing to ramp from
+		previousTimbre = timbre;
 }
 
 bool SynthVoice::isVoiceActive()
@@ -16,11 +16,18 @@
 
 #include <JuceHeader.h>
 #include "QuadOsc.h"
+#include "OrbitEngine.h"
 #include "Envelope.h"
+#include "SilenceDetector.h"
 #include "libMTSClient.h"
 #include <numbers>
 class APAudioProcessor;
 
+// ramp the continuous timbre parameters across each block instead of stepping them
+#ifndef AP_TIMBRE_RAMPS
+ #define AP_TIMBRE_RAMPS 0
+#endif
+
 using namespace std::numbers;
 //==============================================================================
 class SynthVoice : public gin::SynthesiserVoice,
@@ -66,23 +73,30 @@ private:
 
     Envelope env1, env2, env3, env4;
     std::array<Envelope*, 4> envs{&env1, &env2, &env3, &env4};
+    SilenceDetector silence;
+    const std::array<Envelope*, 4> allEnvs{&env1, &env2, &env3, &env4};
     
-	StereoPosition epi1{ 1.0f, 0.0f, 1.0f, 0.0f};
-	StereoPosition epi2{ 1.0, 0.0f, 1.0f, 0.0f };
-	StereoPosition epi3{ 1.0f, 0.0f, 1.0f, 0.0f };
-	StereoPosition epi4{ 1.0f, 0.0f, 1.0f, 0.0f };
+	static constexpr int maxBlockSize = StereoPositionBlock::maxSamples;
 
-	StereoPosition osc1Positions[32];
-	StereoPosition osc2Positions[32];
-	StereoPosition osc3Positions[32];
-	StereoPosition osc4Positions[32];
+	// per-block working storage for the orbital engine, one array per coordinate
+	StereoPositionBlock osc1Positions, osc2Positions, osc3Positions, osc4Positions;
+	float envOutputs[4][maxBlockSize]{}; // output of env1..env4
+	OrbitEngine::Inputs orbitInputs{ .osc = { &osc1Positions, &osc2Positions, &osc3Positions, &osc4Positions },
+		.env = { envOutputs[0], envOutputs[1], envOutputs[2], envOutputs[3] } }; // env: the one assigned to each osc
+	OrbitEngine::Workspace orbits;
+	juce::AudioBuffer<float> synthBuffer{ 2, maxBlockSize };
 
     float currentMidiNote = -1;
     QuadOscillator::Params osc1Params, osc2Params, osc3Params, osc4Params;
 	float osc1Freq = 0.0f, osc2Freq = 0.0f, osc3Freq = 0.0f, osc4Freq = 0.0f;
 	float osc1Vol = 0.0f, osc2Vol = 0.0f, osc3Vol = 0.0f, osc4Vol = 0.0f;
-	int algo{ 0 };
-	float equant{ 0.f }, demodVol{ 2.0f };
+
+	// timbre parameters, read from the mod matrix once per block in updateParams
+	struct TimbreSnapshot {
+		int algo{ 0 };
+		float equant{ 0.f }, demodVol{ 2.0f }, squashK{ 1.f }, blend{ 0.f }, demodmix{ 0.f };
+	};
+	TimbreSnapshot timbre, previousTimbre;
     
 	float baseAmplitude = 0.12f; 
 
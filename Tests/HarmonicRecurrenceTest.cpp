@@ -0,0 +1,60 @@
+/*
+ * Audible Planets - an expressive, quasi-Ptolemaic semi-modular synthesizer
+ *
+ * Copyright 2024, Greg Recco
+ *
+ * Audible Planets is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * All source for Audible Planets is available at
+ * https://github.com/gregrecco67/AudiblePlanets
+ */
+
+// Compares the oscillator's harmonic recurrence (AP_HARMONIC_RECURRENCE) with the
+// direct evaluation it replaced, sineValueForPhaseAndTones, over the whole phase
+// range and every tones setting. The two aren't bit-identical: the recurrence
+// builds the upper partials from one sin/cos pair, so the minimax polynomial's
+// error in that pair is carried up to the 6th partial. Measured, the largest
+// difference is about 2.7e-4 of full scale (tones near 6), so the test allows 5e-4.
+
+#include <JuceHeader.h>
+#include "QuadOsc.h"
+
+namespace
+{
+	constexpr float tolerance = 5.0e-4f;
+	constexpr int numPhases = 20000;
+}
+
+int main()
+{
+	float maxError = 0.f, worstPhase = 0.f, worstTones = 0.f;
+
+	for (int t = 0; t <= 100; t++) {
+		const float tones = 1.0f + 5.0f * (float)t / 100.f;
+		float weights[6], xWeights[6];
+		const int numPartials = QuadOscillator::toneWeights(tones, weights);
+		QuadOscillator::quarterTurnWeights(weights, xWeights);
+
+		for (int i = 0; i < numPhases; i++) {
+			const float phase = -(float)pi + 2.f * (float)pi * (float)i / (float)numPhases;
+			float x, y;
+			QuadOscillator::harmonicPair(phase, weights, xWeights, numPartials, x, y);
+
+			const float directX = sineValueForPhaseAndTones(phase + 0.5f * (float)pi, tones);
+			const float directY = sineValueForPhaseAndTones(phase, tones);
+			const float error = std::max(std::abs(x - directX), std::abs(y - directY));
+			if (error > maxError) {
+				maxError = error;
+				worstPhase = phase;
+				worstTones = tones;
+			}
+		}
+	}
+
+	std::cout << "Harmonic recurrence vs direct: max error " << maxError
+		<< " (phase " << worstPhase << ", tones " << worstTones << "), tolerance " << tolerance << "\n";
+	return maxError <= tolerance ? 0 : 1;
+}
@@ -0,0 +1,225 @@
+/*
+ * Audible Planets - an expressive, quasi-Ptolemaic semi-modular synthesizer
+ *
+ * Copyright 2024, Greg Recco
+ *
+ * Audible Planets is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * All source for Audible Planets is available at
+ * https://github.com/gregrecco67/AudiblePlanets
+ */
+
+// Runs the voice's block-wise orbit kernels, OrbitEngine::render, against the
+// per-sample loop SynthVoice::renderNextBlock used before them. renderPerSample below
+// is that loop with the envelopes and mod matrix reads taken out: it uses
+// StereoPosition and StereoMatrix one sample at a time, fastAtan2 and minimaxSin.
+// Each case is a random block of oscillator positions, envelope values and timbre
+// parameters, for every algorithm and both blend ranges. In some blocks one envelope
+// is 0 throughout, as before its attack, and in some the equant is 0. The parameters are
+// constant over the block, as they were in the per-sample loop, so AP_TIMBRE_RAMPS
+// doesn't come into it.
+//
+// The stages do the same arithmetic in the same order as the loop, so the output has
+// to match bit for bit. That only holds if the compiler doesn't fuse multiply-adds
+// or reassociate differently in the two, so this test is built with FP contraction
+// and fast math off.
+
+#include <JuceHeader.h>
+#include "OrbitEngine.h"
+
+namespace
+{
+	constexpr int numBlocks = 2000;
+
+	struct Block {
+		StereoPositionBlock osc[4];
+		float env[4][OrbitEngine::maxBlockSize];
+		float vol[4];
+		float equant, squashK, blend, demodVol, demodmix;
+		int numSamples;
+	};
+
+	StereoMatrix squashMatrix(const StereoPositionBlock& p, int i, float equant, float k)
+	{
+		// get distances in order to normalize vectors
+		float distanceL = std::sqrt(p.xL[i] * p.xL[i] + (p.yL[i] - equant) * (p.yL[i] - equant));
+		float distanceR = std::sqrt(p.xR[i] * p.xR[i] + (p.yR[i] - equant) * (p.yR[i] - equant));
+		// normalized vectors
+		float cosThetaL = (p.yL[i] - equant) / (distanceL + .000001f);
+		float sinThetaL = -p.xL[i] / (distanceL + .000001f);
+		float cosThetaR = (p.yR[i] - equant) / (distanceR + .000001f);
+		float sinThetaR = -p.xR[i] / (distanceR + .000001f);
+		float cos2ThetaL = cosThetaL * cosThetaL;
+		float cos2ThetaR = cosThetaR * cosThetaR;
+		float sin2ThetaL = sinThetaL * sinThetaL;
+		float sin2ThetaR = sinThetaR * sinThetaR;
+
+		return {
+			.left = {
+				.a = cos2ThetaL + k * sin2ThetaL, .b = cosThetaL * sinThetaL * (1.0f - k),
+				.c = cosThetaL * sinThetaL * (1.0f - k), .d = sin2ThetaL + k * cos2ThetaL
+			},
+			.right = {
+				.a = cos2ThetaR + k * sin2ThetaR, .b = cosThetaR * sinThetaR * (1.0f - k),
+				.c = cosThetaR * sinThetaR * (1.0f - k), .d = sin2ThetaR + k * cos2ThetaR
+			}
+		};
+	}
+
+	StereoPosition at(const StereoPositionBlock& p, int i) { return { p.xL[i], p.yL[i], p.xR[i], p.yR[i] }; }
+
+	// the mod and demod samples of one body, as the per-sample loop worked them out
+	void body(const StereoPosition& epi, float env, float equant, float blend, float demodVol,
+		float& modL, float& modR, float& demodL, float& demodR)
+	{
+		const float angleL = FastMath<float>::fastAtan2(epi.yL - equant, epi.xL);
+		const float angleR = FastMath<float>::fastAtan2(epi.yR - equant, epi.xR);
+		const float sineL = FastMath<float>::minimaxSin(angleL), sineR = FastMath<float>::minimaxSin(angleR);
+		const float squareL = (angleL > 0.f) ? 1.0f : -1.0f, squareR = (angleR > 0.f) ? 1.0f : -1.0f;
+		const float sawL = (angleL * (float)inv_pi) * 2.0f - 1.0f, sawR = (angleR * (float)inv_pi) * 2.0f - 1.0f;
+
+		float sampleL, sampleR;
+		if (blend < 0.5f) {
+			sampleL = (sineL * (1.f - blend * 2.0f) + squareL * blend * 2.0f);
+			sampleR = (sineR * (1.f - blend * 2.0f) + squareR * blend * 2.0f);
+		}
+		else {
+			sampleL = (squareL * (1.0f - blend) * 2.0f + sawL * (blend - 0.5f) * 2.f);
+			sampleR = (squareR * (1.0f - blend) * 2.0f + sawR * (blend - 0.5f) * 2.f);
+		}
+
+		const float distanceL = (float)std::sqrt(epi.xL * epi.xL + (epi.yL - equant) * (epi.yL - equant));
+		const float distanceR = (float)std::sqrt(epi.xR * epi.xR + (epi.yR - equant) * (epi.yR - equant));
+		demodL = sampleL * (distanceL * demodVol);
+		demodR = sampleR * (distanceR * demodVol);
+		modL = sampleL * env;
+		modR = sampleR * env;
+	}
+
+	void renderPerSample(const Block& b, int algo, float* outL, float* outR)
+	{
+		const float k = b.squashK, equant = b.equant, demodmix = b.demodmix;
+		for (int i = 0; i < b.numSamples; i++) {
+			const float e1 = b.env[0][i], e2 = b.env[1][i], e3 = b.env[2][i], e4 = b.env[3][i];
+			StereoMatrix squash1 = squashMatrix(b.osc[0], i, equant, k);
+			StereoMatrix squash2 = squashMatrix(b.osc[1], i, equant, k);
+			StereoMatrix squash3 = squashMatrix(b.osc[2], i, equant, k);
+
+			StereoPosition epi1 = at(b.osc[0], i) * (e1 * b.vol[0]);
+			StereoPosition epi2 = epi1 + ((at(b.osc[1], i) * squash1) * (e2 * b.vol[1]));
+			StereoPosition epi3, epi4;
+			if (algo == 0) { // 1-2-3-(4)
+				epi3 = epi2 + ((at(b.osc[2], i) * squash2) * (e3 * b.vol[2]));
+				epi4 = epi3 + ((at(b.osc[3], i) * squash3) * (e4 * b.vol[3]));
+			}
+			if (algo == 1) { // 1-2-(3), 2-(4)
+				epi3 = epi2 + ((at(b.osc[2], i) * squash2) * (e3 * b.vol[2]));
+				epi4 = epi2 + ((at(b.osc[3], i) * squash2) * (e4 * b.vol[3]));
+			}
+			if (algo == 2) { // 1-(2), 1-3-(4)
+				epi3 = epi1 + ((at(b.osc[2], i) * squash1) * (e3 * b.vol[2]));
+				epi4 = epi3 + ((at(b.osc[3], i) * squash3) * (e4 * b.vol[3]));
+			}
+			if (algo == 3) { // 1-(2), 1-(3), 1-(4)
+				epi3 = epi1 + ((at(b.osc[2], i) * squash1) * (e3 * b.vol[2]));
+				epi4 = epi1 + ((at(b.osc[3], i) * squash1) * (e4 * b.vol[3]));
+			}
+
+			float mod2L, mod2R, demod2L, demod2R, mod3L, mod3R, demod3L, demod3R, mod4L, mod4R, demod4L, demod4R;
+			body(epi2, e2, equant, b.blend, b.demodVol, mod2L, mod2R, demod2L, demod2R);
+			body(epi3, e3, equant, b.blend, b.demodVol, mod3L, mod3R, demod3L, demod3R);
+			body(epi4, e4, equant, b.blend, b.demodVol, mod4L, mod4R, demod4L, demod4R);
+
+			if (algo == 0) {
+				outL[i] = (mod4L * (1.0f - demodmix) + demod4L * demodmix);
+				outR[i] = (mod4R * (1.0f - demodmix) + demod4R * demodmix);
+			}
+			if (algo == 1) {
+				outL[i] = ((mod3L + mod4L) * 0.5f * (1.0f - demodmix) + (demod3L + demod4L) * 0.5f * demodmix);
+				outR[i] = ((mod3R + mod4R) * 0.5f * (1.0f - demodmix) + (demod3R + demod4R) * 0.5f * demodmix);
+			}
+			if (algo == 2) {
+				outL[i] = ((mod2L + mod4L) * 0.5f * (1.0f - demodmix) + (demod2L + demod4L) * 0.5f * demodmix);
+				outR[i] = ((mod2R + mod4R) * 0.5f * (1.0f - demodmix) + (demod2R + demod4R) * 0.5f * demodmix);
+			}
+			if (algo == 3) {
+				outL[i] = ((mod2L + mod3L + mod4L) * 0.333f * (1.0f - demodmix) + (demod2L + demod3L + demod4L) * 0.333f * demodmix);
+				outR[i] = ((mod2R + mod3R + mod4R) * 0.333f * (1.0f - demodmix) + (demod2R + demod3L + demod4R) * 0.333f * demodmix);
+			}
+		}
+	}
+
+	void fillBlock(Block& b, juce::Random& random)
+	{
+		auto between = [&random](float lo, float hi) { return lo + (hi - lo) * random.nextFloat(); };
+		b.numSamples = 1 + random.nextInt(OrbitEngine::maxBlockSize);
+		const int silentEnv = random.nextInt(8); // 0-3: that envelope is 0 for the block
+		for (int o = 0; o < 4; o++) {
+			b.vol[o] = between(0.0f, 1.0f);
+			for (int i = 0; i < b.numSamples; i++) {
+				b.osc[o].xL[i] = between(-1.0f, 1.0f);
+				b.osc[o].yL[i] = between(-1.0f, 1.0f);
+				b.osc[o].xR[i] = between(-1.0f, 1.0f);
+				b.osc[o].yR[i] = between(-1.0f, 1.0f);
+				b.env[o][i] = o == silentEnv ? 0.0f : between(0.0f, 1.0f);
+			}
+		}
+		b.equant = random.nextInt(4) == 0 ? 0.0f : between(-0.5f, 0.5f);
+		b.squashK = 1.0f - between(0.0f, 1.0f);
+		b.blend = between(0.0f, 1.0f);
+		b.demodVol = between(0.0f, 3.0f);
+		b.demodmix = between(0.0f, 1.0f);
+	}
+}
+
+int main()
+{
+	juce::Random random(7);
+	auto block = std::make_unique<Block>();
+	auto workspace = std::make_unique<OrbitEngine::Workspace>();
+	bool passed = true;
+
+	for (int algo = 0; algo < 4; algo++) {
+		for (bool sineToSquare : { true, false }) {
+			int mismatches = 0;
+			float maxError = 0.0f;
+			for (int n = 0; n < numBlocks; n++) {
+				fillBlock(*block, random);
+				if ((block->blend < 0.5f) != sineToSquare)
+					block->blend = sineToSquare ? block->blend - 0.5f : block->blend + 0.5f;
+
+				OrbitEngine::Inputs inputs;
+				for (int o = 0; o < 4; o++) {
+					inputs.osc[o] = &block->osc[o];
+					inputs.env[o] = block->env[o];
+					inputs.vol[o] = block->vol[o];
+				}
+				inputs.equant = block->equant;
+				inputs.blend = block->blend;
+				inputs.squashK.set(block->squashK, block->squashK, block->numSamples, false);
+				inputs.demodVol.set(block->demodVol, block->demodVol, block->numSamples, false);
+				inputs.demodmix.set(block->demodmix, block->demodmix, block->numSamples, false);
+
+				float outL[OrbitEngine::maxBlockSize], outR[OrbitEngine::maxBlockSize];
+				float expectedL[OrbitEngine::maxBlockSize], expectedR[OrbitEngine::maxBlockSize];
+				OrbitEngine::render(algo, inputs, *workspace, outL, outR, block->numSamples);
+				renderPerSample(*block, algo, expectedL, expectedR);
+
+				for (int i = 0; i < block->numSamples; i++) {
+					mismatches += (outL[i] != expectedL[i]) + (outR[i] != expectedR[i]);
+					maxError = std::max({ maxError, std::abs(outL[i] - expectedL[i]), std::abs(outR[i] - expectedR[i]) });
+				}
+			}
+
+			const bool ok = mismatches == 0;
+			std::cout << (ok ? "ok   " : "FAIL ") << "algorithm " << algo << (sineToSquare ? ", sine-square" : ", square-saw")
+				<< ": " << mismatches << " samples differ, max |block - per sample| " << maxError << "\n";
+			passed &= ok;
+		}
+	}
+
+	return passed ? 0 : 1;
+}
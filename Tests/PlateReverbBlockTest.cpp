@@ -0,0 +1,106 @@
+/*
+ * Audible Planets - an expressive, quasi-Ptolemaic semi-modular synthesizer
+ *
+ * Copyright 2024, Greg Recco
+ *
+ * Audible Planets is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * All source for Audible Planets is available at
+ * https://github.com/gregrecco67/AudiblePlanets
+ */
+
+// Runs the plate reverb's block path, process(context), against its per-sample path,
+// process(left, right, ...), which is the original algorithm. Each run is one second
+// of noise followed by one second of silence, at host block sizes from 1 to 1000.
+// Most of the sizes aren't multiples of the 256-sample runs the block path works in.
+// Size and predelay change four times per run. Each change lands on the first host
+// block boundary after samples 700, 5000, 9001 and 20000, which are never a multiple
+// of 256. The two paths do the same arithmetic in the same order, so the measured
+// difference is 0; the test allows 1e-6 for compilers that contract multiply-adds
+// differently.
+
+#include <JuceHeader.h>
+#include "FXProcessors.h"
+
+namespace
+{
+	using Reverb = PlateReverb<float, uint32_t>;
+
+	constexpr double sampleRate = 48000.0;
+	constexpr int numSamples = 96000;
+	constexpr int noiseSamples = 48000;
+	constexpr float tolerance = 1.0e-6f;
+	constexpr int changeAt[] = { 700, 5000, 9001, 20000 };
+
+	void setUp(Reverb& reverb)
+	{
+		reverb.prepare({ sampleRate, 1024, 2 });
+		reverb.setSize(1.7f);
+		reverb.setDecay(0.8f);
+		reverb.setDamping(6000.0f);
+		reverb.setLowpass(9000.0f);
+		reverb.setPredelay(0.013f);
+		reverb.setDry(0.6f);
+		reverb.setWet(0.5f);
+	}
+}
+
+int main()
+{
+	bool passed = true;
+
+	for (int blockSize : { 1, 37, 255, 256, 257, 300, 511, 1000 }) {
+		Reverb block, perSample;
+		setUp(block);
+		setUp(perSample);
+
+		juce::Random random(3);
+		std::vector<float> left, right, expectedLeft, expectedRight;
+		float maxError = 0.0f;
+		size_t nextChange = 0;
+
+		for (int pos = 0; pos < numSamples; pos += blockSize) {
+			const int n = std::min(blockSize, numSamples - pos);
+
+			if (nextChange < std::size(changeAt) && pos >= changeAt[nextChange]) {
+				const float size = 0.5f + 0.6f * (float)nextChange;
+				const float predelay = 0.002f + 0.03f * (float)nextChange;
+				for (auto* reverb : { &block, &perSample }) {
+					reverb->setSize(size);
+					reverb->setPredelay(predelay);
+				}
+				nextChange++;
+			}
+
+			left.resize((size_t)n);
+			right.resize((size_t)n);
+			for (int i = 0; i < n; i++) {
+				const bool noise = pos + i < noiseSamples;
+				left[(size_t)i] = noise ? random.nextFloat() * 2.0f - 1.0f : 0.0f;
+				right[(size_t)i] = noise ? random.nextFloat() * 2.0f - 1.0f : 0.0f;
+			}
+			expectedLeft = left;
+			expectedRight = right;
+
+			float* channels[] = { left.data(), right.data() };
+			juce::dsp::AudioBlock<float> audio(channels, 2, (size_t)n);
+			block.process(juce::dsp::ProcessContextReplacing<float>(audio));
+
+			for (size_t i = 0; i < (size_t)n; i++)
+				perSample.process(expectedLeft[i], expectedRight[i], &expectedLeft[i], &expectedRight[i]);
+
+			for (size_t i = 0; i < (size_t)n; i++)
+				maxError = std::max({ maxError, std::abs(left[i] - expectedLeft[i]), std::abs(right[i] - expectedRight[i]) });
+		}
+
+		const bool ok = maxError <= tolerance;
+		std::cout << (ok ? "ok   " : "FAIL ") << "host blocks of " << blockSize
+			<< ": max |block - per sample| " << maxError << "\n";
+		passed &= ok;
+	}
+
+	return passed ? 0 : 1;
+}
@@ -0,0 +1,79 @@
+/*
+ * Audible Planets - an expressive, quasi-Ptolemaic semi-modular synthesizer
+ *
+ * Copyright 2024, Greg Recco
+ *
+ * Audible Planets is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * All source for Audible Planets is available at
+ * https://github.com/gregrecco67/AudiblePlanets
+ */
+
+// Runs the ring modulator's four-lane filter (RingModulator::QuadSVF) against four
+// juce::dsp::StateVariableTPTFilters, one per lane, on independent noise. It covers
+// lowpass and highpass at both sample rates the ring modulator runs at, with cutoffs
+// from 20 Hz to 20 kHz, and halves the cutoff halfway through each run. The topology
+// is the same, but QuadSVF works out its h coefficient in float where JUCE uses
+// double. The largest |QuadSVF - JUCE| measured was 5.4e-7, and the test allows 1e-6.
+
+#include <JuceHeader.h>
+#include "FXProcessors.h"
+
+namespace
+{
+	constexpr int numSamples = 20000;
+	constexpr float tolerance = 1.0e-6f;
+}
+
+int main()
+{
+	using Reg = juce::dsp::SIMDRegister<float>;
+	bool passed = true;
+
+	for (double sampleRate : { 88200.0, 96000.0 }) { // the ring modulator runs 2x oversampled
+		for (float cutoff : { 20.0f, 1000.0f, 8000.0f, 20000.0f }) {
+			for (bool highpass : { false, true }) {
+				RingModulator::QuadSVF quad;
+				quad.prepare(sampleRate);
+				quad.setCutoffFrequency(cutoff);
+
+				std::array<juce::dsp::StateVariableTPTFilter<float>, 4> reference;
+				for (auto& filter : reference) {
+					filter.prepare({ sampleRate, (juce::uint32)numSamples, 1 });
+					filter.setType(highpass ? juce::dsp::StateVariableTPTFilterType::highpass
+						: juce::dsp::StateVariableTPTFilterType::lowpass);
+					filter.setCutoffFrequency(cutoff);
+				}
+
+				juce::Random random(3);
+				float maxError = 0.0f;
+				for (int i = 0; i < numSamples; i++) {
+					if (i == numSamples / 2) {
+						quad.setCutoffFrequency(cutoff * 0.5f);
+						for (auto& filter : reference)
+							filter.setCutoffFrequency(cutoff * 0.5f);
+					}
+
+					alignas(Reg::SIMDRegisterSize) float in[4], out[4];
+					for (auto& x : in)
+						x = random.nextFloat() * 2.0f - 1.0f;
+					const Reg x = Reg::fromRawArray(in);
+					(highpass ? quad.highpass(x) : quad.lowpass(x)).copyToRawArray(out);
+
+					for (size_t lane = 0; lane < 4; lane++)
+						maxError = std::max(maxError, std::abs(out[lane] - reference[lane].processSample(0, in[lane])));
+				}
+
+				const bool ok = maxError <= tolerance;
+				std::cout << (ok ? "ok   " : "FAIL ") << (highpass ? "highpass " : "lowpass ") << cutoff << " Hz at "
+					<< sampleRate << " Hz: max |QuadSVF - JUCE| " << maxError << "\n";
+				passed &= ok;
+			}
+		}
+	}
+
+	return passed ? 0 : 1;
+}
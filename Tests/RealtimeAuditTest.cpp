@@ -0,0 +1,106 @@
+/*
+ * Audible Planets - an expressive, quasi-Ptolemaic semi-modular synthesizer
+ *
+ * Copyright 2024, Greg Recco
+ *
+ * Audible Planets is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * All source for Audible Planets is available at
+ * https://github.com/gregrecco67/AudiblePlanets
+ */
+
+// Drives processBlock with generated MIDI (overlapping notes, enough of them to steal
+// voices, sustain pedal, mod wheel and filter CCs, and pitch bend) and fails if the
+// real-time audit saw the audio thread allocate or wait on a mutex. It runs once on
+// the audio thread alone, then again with voice render threads and parallel FX lanes.
+// Without the audit (release builds without AP_REALTIME_AUDIT) there's nothing to
+// check, and it exits with the code ctest counts as skipped.
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+
+#if AP_REALTIME_AUDIT
+namespace
+{
+	constexpr double sampleRate = 48000.0;
+	constexpr int blockSize = 512;
+	constexpr int numBlocks = 2000; // about 21 s
+
+	void addGeneratedEvents(juce::Random& random, juce::MidiBuffer& midi, juce::Array<int>& heldNotes, int block)
+	{
+		if (random.nextFloat() < 0.4f) {
+			const int note = 36 + random.nextInt(60);
+			midi.addEvent(juce::MidiMessage::noteOn(1, note, juce::uint8(1 + random.nextInt(127))), random.nextInt(blockSize));
+			heldNotes.addIfNotAlreadyThere(note);
+		}
+		if (!heldNotes.isEmpty() && random.nextFloat() < 0.35f) {
+			const int index = random.nextInt(heldNotes.size());
+			midi.addEvent(juce::MidiMessage::noteOff(1, heldNotes[index]), random.nextInt(blockSize));
+			heldNotes.remove(index);
+		}
+		if (block % 64 == 0)
+			midi.addEvent(juce::MidiMessage::controllerEvent(1, 64, (block / 64) % 2 == 0 ? 127 : 0), 0);
+		if (random.nextFloat() < 0.5f)
+			midi.addEvent(juce::MidiMessage::controllerEvent(1, 1, random.nextInt(128)), random.nextInt(blockSize));
+		if (random.nextFloat() < 0.2f)
+			midi.addEvent(juce::MidiMessage::controllerEvent(1, 74, random.nextInt(128)), random.nextInt(blockSize));
+		if (random.nextFloat() < 0.5f)
+			midi.addEvent(juce::MidiMessage::pitchWheel(1, random.nextInt(16384)), random.nextInt(blockSize));
+	}
+
+	int run(int numThreads, bool parallelFX)
+	{
+		auto proc = std::make_unique<APAudioProcessor>();
+		proc->setVoiceRenderThreads(numThreads);
+		proc->setParallelFXLanes(parallelFX);
+		proc->setPlayConfigDetails(0, 2, sampleRate, blockSize);
+		proc->prepareToPlay(sampleRate, blockSize);
+
+		juce::AudioBuffer<float> buffer(2, blockSize);
+		juce::MidiBuffer midi;
+		midi.ensureSize(4096);
+		juce::Array<int> heldNotes;
+		heldNotes.ensureStorageAllocated(128);
+		juce::Random random(0x41504c41);
+
+		const int before = RealtimeAudit::getNumViolations();
+		for (int block = 0; block < numBlocks; block++) {
+			midi.clear();
+			if (block < numBlocks - 200) {
+				addGeneratedEvents(random, midi, heldNotes, block);
+			}
+			else if (!heldNotes.isEmpty()) { // let everything release before the end
+				for (int note : heldNotes)
+					midi.addEvent(juce::MidiMessage::noteOff(1, note), 0);
+				midi.addEvent(juce::MidiMessage::controllerEvent(1, 64, 0), 0);
+				heldNotes.clear();
+			}
+
+			buffer.clear();
+			proc->processBlock(buffer, midi);
+		}
+		proc->releaseResources();
+
+		const int found = RealtimeAudit::getNumViolations() - before;
+		std::cout << (found == 0 ? "ok   " : "FAIL ") << numThreads << " voice thread(s)"
+			<< (parallelFX ? ", parallel FX lanes" : "") << ": " << found << " problem(s)\n";
+		return found;
+	}
+}
+#endif
+
+int main()
+{
+	juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+#if AP_REALTIME_AUDIT
+	const int found = run(0, false) + run(2, true);
+	return found > 0 ? 1 : 0;
+#else
+	std::cout << "The real-time audit isn't built in; build with AP_REALTIME_AUDIT to run this test\n";
+	return 77; // SKIP_RETURN_CODE in CMakeLists.txt
+#endif
+}
@@ -0,0 +1,86 @@
+/*
+ * Audible Planets - an expressive, quasi-Ptolemaic semi-modular synthesizer
+ *
+ * Copyright 2024, Greg Recco
+ *
+ * Audible Planets is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html
+ *
+ * All source for Audible Planets is available at
+ * https://github.com/gregrecco67/AudiblePlanets
+ */
+
+// Shapes a sweep over [-1.5, 1.5] with the waveshaper's block kernel, for every curve
+// that has a register kernel, and checks it against shapeSample one sample at a time.
+// The buffers start one sample past an aligned address and aren't a whole number of
+// registers long, so the unaligned loads and the scalar remainder are both covered.
+// The kernel does the same arithmetic in the same order, so the measured difference
+// is 0; the test allows 1e-6 for compilers that contract multiply-adds differently.
+//
+// Also pins down the halfwave curve, which is 0 for x <= 0 and tanh(1.5x) / tanh(1.5)
+// above it, clamped at 1. At exactly x = 1 it's 1, like the curve either side of it:
+// before the curve moved to a table, x = 1 fell through to the x <= 0 branch and gave 0.
+
+#include <JuceHeader.h>
+#include "FXProcessors.h"
+
+namespace
+{
+	constexpr int numSamples = 1003;
+	constexpr float tolerance = 1.0e-6f;
+
+	bool check(bool condition, const juce::String& what)
+	{
+		std::cout << (condition ? "ok   " : "FAIL ") << what << "\n";
+		return condition;
+	}
+}
+
+int main()
+{
+	WaveShaperProcessor shaper;
+	bool passed = true;
+
+	std::vector<float> sweep((size_t)numSamples);
+	for (int i = 0; i < numSamples; i++)
+		sweep[(size_t)i] = -1.5f + 3.0f * (float)i / (float)(numSamples - 1);
+	// the ends of the tables and the clamps, exactly
+	sweep[100] = -1.0f;
+	sweep[101] = 0.0f;
+	sweep[102] = 1.0f;
+
+	for (int function = 0; function <= 16; function++) {
+		if (!WaveShaperProcessor::hasRegisterKernel(function))
+			continue;
+
+		std::vector<float> left((size_t)numSamples + 1), right((size_t)numSamples + 1);
+		std::copy(sweep.begin(), sweep.end(), left.begin() + 1);
+		std::copy(sweep.rbegin(), sweep.rend(), right.begin() + 1);
+
+		shaper.setFunctionToUse(function);
+		shaper.shapeBlock(left.data() + 1, right.data() + 1, numSamples);
+
+		std::vector<float> expected(sweep);
+		std::vector<float> reversed(sweep.rbegin(), sweep.rend());
+		shaper.setFunctionToUse(function);
+		float maxError = 0.0f;
+		for (int i = 0; i < numSamples; i++) {
+			float l = expected[(size_t)i], r = reversed[(size_t)i];
+			shaper.shapeBlock(&l, &r, 1); // one sample never reaches the kernel
+			maxError = std::max({ maxError, std::abs(left[(size_t)i + 1] - l), std::abs(right[(size_t)i + 1] - r) });
+		}
+		passed &= check(maxError <= tolerance, "function " + juce::String(function)
+			+ ": max |kernel - shapeSample| " + juce::String(maxError));
+	}
+
+	auto halfwave = [&shaper](float x) { return shaper.shapeSample<11>(x); };
+	passed &= check(halfwave(-0.5f) == 0.0f && halfwave(0.0f) == 0.0f, "halfwave is 0 for x <= 0");
+	passed &= check(std::abs(halfwave(1.0f) - 1.0f) <= tolerance, "halfwave(1) is 1");
+	passed &= check(std::abs(halfwave(0.9999f) - halfwave(1.0f)) < 1.0e-3f, "halfwave is continuous at 1");
+	passed &= check(std::abs(halfwave(1.5f) - 1.0f) <= tolerance, "halfwave is 1 above 1");
+	passed &= check(std::abs(halfwave(0.5f) - std::tanh(0.75f) / std::tanh(1.5f)) < 1.0e-4f, "halfwave(0.5) is tanh(0.75) / tanh(1.5)");
+
+	return passed ? 0 : 1;
+}